@@ -22,11 +22,43 @@ class TW_LootableInventoryComponent : ScriptComponent
 	
 	protected int m_RespawnLootAfterTime = -1;
 	
+	// Incremented every time the container is reset, so queued work for a previous cycle can be recognized as stale
+	protected int m_LootCycle;
+	
+	// Interned grid cell of the owner's origin. Containers are static, so this is resolved once
+	protected int m_GridCellId = -1;
+	
+	// Virtual mode: contents held as data, spawned only when a player opens the container
+	protected ref TW_LootManifest m_Manifest = new TW_LootManifest();
+	protected bool m_IsVirtual;
+	protected bool m_IsQueuedForVirtualize;
+	protected float m_LastInteractionTime;
+	
+	// Loot was rolled ahead of the first search, see TW_LootManager.ProcessPrewarmQueue
+	protected bool m_IsPrewarmed;
+	
+	// The manifest was pre-rolled and carries no ammo, items get randomized ammo like trickled loot
+	protected bool m_RandomizeManifestAmmo;
+	
 	protected ref ScriptInvoker<bool> m_OnLootReset = new ScriptInvoker<bool>();
 	
 	ScriptInvoker<bool> GetOnLootReset() { return m_OnLootReset; }
 	
 	bool HasBeenInteractedWith() { return m_HasBeenInteractedWith; }
+	int GetRespawnLootAfterTime() { return m_RespawnLootAfterTime; }
+	int GetLootCycle() { return m_LootCycle; }
+	int GetGridCellId() { return m_GridCellId; }
+	void SetGridCellId(int cellId) { m_GridCellId = cellId; }
+	
+	bool IsVirtual() { return m_IsVirtual; }
+	TW_LootManifest GetManifest() { return m_Manifest; }
+	float GetLastInteractionTime() { return m_LastInteractionTime; }
+	bool IsQueuedForVirtualize() { return m_IsQueuedForVirtualize; }
+	bool IsPrewarmed() { return m_IsPrewarmed; }
+	
+	//! Pre-rolled loot was spawned as entities ahead of a search, see Unstage
+	bool IsStaged() { return m_IsPrewarmed && !m_IsVirtual; }
+	void SetQueuedForVirtualize(bool value) { m_IsQueuedForVirtualize = value; }
 	
 	//! Player has interacted with storage container AND respawn timer has elapsed
 	bool CanRespawnLoot()
@@ -48,7 +80,8 @@ class TW_LootableInventoryComponent : ScriptComponent
 		container.SetInteractedWith(value);
 	}
 	
-	void SetInteractedWith(bool value) 
+	//! interactor is the character that searched the container, used to prioritize its loot
+	void SetInteractedWith(bool value, IEntity interactor = null) 
 	{ 	
 		bool old = m_HasBeenInteractedWith;
 		m_HasBeenInteractedWith = value;
@@ -61,16 +94,41 @@ class TW_LootableInventoryComponent : ScriptComponent
 		
 		if(value)
 		{
+			// If we've interacted with we'll reset the timer
+			// Set before registering so the respawn scheduler queues the right deadline
+			float elapsed = GetGameMode().GetElapsedTime();
+			m_RespawnLootAfterTime = elapsed + (TW_LootManager.GetInstance().GetRespawnAfterLastInteractionInMinutes() * 60);
+			m_LastInteractionTime = elapsed;
+			
+			TW_LootTrace.Record(TW_LootTraceEvent.ContainerSearched, GetOwner().GetOrigin());
+			
+			// Opening the storage (SCR_OpenStorageAction -> SetContainerInteraction) is what brings virtual loot back
+			if(m_IsVirtual)
+			{
+				Materialize(interactor);
+				TW_LootTrace.Record(TW_LootTraceEvent.ContainerMaterialized, GetOwner().GetOrigin());
+			}
+			
+			// Pre-rolled loot is already there, nothing to trickle in
+			bool wasPrewarmed = m_IsPrewarmed;
+			
+			// Staging still in progress, the rest is no longer background work
+			if(IsStaged())
+				TW_LootManager.PromoteQueuedLoot(this, interactor);
+			
+			m_IsPrewarmed = false;
+			
 			// We will not reregister the object if it's been interacted with already
 			if(!old)
 			{
 				TW_LootManager.RegisterInteractedContainer(this);
-				TW_LootManager.GetInstance().TrickleSpawnLootInContainer(this, TW_LootManager.GetInstance().GetRespawnLootItemThreshold());
+				
+				if(!wasPrewarmed)
+					TW_LootManager.GetInstance().TrickleSpawnLootInContainer(this, TW_LootManager.GetInstance().GetRespawnLootItemThreshold(), interactor);
 			}
 			
-			// If we've interacted with we'll reset the timer
-			float elapsed = GetGameMode().GetElapsedTime();
-			m_RespawnLootAfterTime = elapsed + (TW_LootManager.GetInstance().GetRespawnAfterLastInteractionInMinutes() * 60);
+			TW_LootManager.QueueForVirtualize(this);
+			
 			GetOnLootReset().Invoke(true);
 			Rpc(RPCAsk_Broadcast_InteractionUpdate, m_Rpl.Id(), true);
 		}
@@ -84,17 +142,216 @@ class TW_LootableInventoryComponent : ScriptComponent
 				That way when player returns to loot the container they have
 				to do a "long press" to search, and items will trickle spawn in
 			*/
-			ref array<IEntity> items = {};
-			GetStorageManager().GetItems(items);
+			m_LootCycle++;
+			TW_LootManager.CancelQueuedLoot(this);
+			
+			if(old)
+				TW_LootManager.ReleaseInteractedContainer();
 			
-			foreach(IEntity item : items)
-				GetStorageManager().TryDeleteItem(item);
+			m_Manifest.Clear();
+			m_IsVirtual = false;
+			m_IsQueuedForVirtualize = false;
+			m_IsPrewarmed = false;
+			m_RandomizeManifestAmmo = false;
+			
+			ClearItems();
 			
 			GetOnLootReset().Invoke(false);
 			Rpc(RPCAsk_Broadcast_InteractionUpdate, m_Rpl.Id(), false);
 		}
 	}
 	
+	//! Mark the container as searched and empty after a restart. Loot respawns once remainingSeconds have passed
+	void RestoreInteractionState(int remainingSeconds)
+	{
+		if(m_HasBeenInteractedWith || !m_Rpl || !m_Rpl.IsMaster())
+			return;
+		
+		float elapsed = GetGameMode().GetElapsedTime();
+		m_HasBeenInteractedWith = true;
+		m_RespawnLootAfterTime = elapsed + Math.Max(remainingSeconds, 1);
+		m_LastInteractionTime = elapsed;
+		
+		TW_LootManager.RegisterInteractedContainer(this);
+		GetOnLootReset().Invoke(true);
+	}
+	
+	//! Remove every item from the container. Common loot lying directly in this storage is parked for reuse rather than deleted
+	protected void ClearItems()
+	{
+		ref array<IEntity> items = {};
+		GetStorageManager().GetItems(items);
+		
+		foreach(IEntity item : items)
+		{
+			if(!item)
+				continue;
+			
+			if(m_Storage && m_Storage.Contains(item) && m_StorageManager.TryRemoveItemFromStorage(item, m_Storage))
+			{
+				if(!TW_LootManager.RecycleItem(item))
+					SCR_EntityHelper.DeleteEntityAndChildren(item);
+				
+				continue;
+			}
+			
+			GetStorageManager().TryDeleteItem(item);
+		}
+	}
+	
+	/*
+		Turn the container's entities into manifest records and remove them.
+		
+		Only undamaged loot table items can be described. Weapons are recorded with
+		the ammo of their current magazine and come back with their prefab
+		attachments, so one holding anything else, such as a fitted scope or a
+		swapped magazine, keeps the container materialized. So does any other item
+		holding entities, and anything not in the item index.
+	*/
+	bool Virtualize()
+	{
+		// A manifest that is still being materialized has not become entities yet
+		if(m_IsVirtual || !m_Manifest.IsEmpty() || !m_StorageManager || !m_Storage)
+			return false;
+		
+		ref array<IEntity> items = {};
+		m_Storage.GetAll(items);
+		
+		ref TW_LootManifest manifest = new TW_LootManifest();
+		
+		foreach(IEntity item : items)
+		{
+			if(!item || !item.GetPrefabData())
+				return false;
+			
+			TW_LootItemInfo info = TW_LootManager.GetItemInfo(item.GetPrefabData().GetPrefabName());
+			
+			if(!info || TW_LootManager.IsDamaged(item))
+				return false;
+			
+			int ammo = -1;
+			
+			if(info.HasWeapon())
+			{
+				// Materializing gives back the prefab's own attachments and magazine
+				if(!info.HasSpawnedChildren(item))
+					return false;
+				
+				BaseWeaponComponent weapon = BaseWeaponComponent.Cast(item.FindComponent(BaseWeaponComponent));
+				
+				if(weapon && weapon.GetCurrentMagazine())
+					ammo = weapon.GetCurrentMagazine().GetAmmoCount();
+			}
+			else
+			{
+				if(item.GetChildren())
+					return false;
+				
+				BaseMagazineComponent magazine = BaseMagazineComponent.Cast(item.FindComponent(BaseMagazineComponent));
+				
+				if(magazine)
+					ammo = magazine.GetAmmoCount();
+			}
+			
+			manifest.Add(info.GetId(), ammo);
+		}
+		
+		// Also covers items nested inside others, which the check above already ruled out
+		ClearItems();
+		
+		m_Manifest = manifest;
+		m_IsVirtual = true;
+		m_RandomizeManifestAmmo = false;
+		return true;
+	}
+	
+	//! Roll the loot a search would trickle in as a manifest and load its prefabs, optionally spawning it right away.
+	//! Returns the number of items rolled
+	int Prewarm(notnull TW_LootPool pool, int rolls, bool stageEntities)
+	{
+		if(m_HasBeenInteractedWith || m_IsPrewarmed)
+			return 0;
+		
+		m_Manifest.Clear();
+		
+		for(int i = 0; i < rolls; i++)
+		{
+			TW_LootConfigItem item = pool.GetRandomItem();
+			
+			if(!item || !TW_LootManager.GetPrefabResource(item.resourceName))
+				continue;
+			
+			int itemId = TW_LootManager.GetItemId(item.resourceName);
+			
+			if(itemId >= 0)
+				m_Manifest.Add(itemId);
+		}
+		
+		int itemCount = m_Manifest.GetItemCount();
+		m_IsVirtual = true;
+		m_IsPrewarmed = true;
+		m_RandomizeManifestAmmo = true;
+		
+		if(stageEntities)
+			Materialize(null, true);
+		
+		return itemCount;
+	}
+	
+	//! Remove loot staged ahead of a search that never came. The container is rolled again when a player comes back
+	void Unstage()
+	{
+		if(m_HasBeenInteractedWith || !IsStaged())
+			return;
+		
+		m_LootCycle++;
+		TW_LootManager.CancelQueuedLoot(this);
+		
+		m_Manifest.Clear();
+		m_IsPrewarmed = false;
+		m_RandomizeManifestAmmo = false;
+		
+		ClearItems();
+	}
+	
+	//! Queue the manifest to spawn back into real entities. opener is served first, like rolled loot, background work last
+	void Materialize(IEntity opener = null, bool isBackground = false)
+	{
+		if(!m_IsVirtual)
+			return;
+		
+		m_IsVirtual = false;
+		TW_LootManager.QueueMaterialize(this, m_Manifest.GetItemCount(), opener, isBackground);
+	}
+	
+	//! Spawn one manifest item. Called by the loot spawn queue, returns false once the manifest is empty
+	bool MaterializeNext()
+	{
+		int itemId;
+		int ammo;
+		
+		if(m_IsVirtual || !m_Manifest.PopItem(itemId, ammo))
+			return false;
+		
+		TW_LootItemInfo info = TW_LootManager.GetItemInfoById(itemId);
+		
+		if(!info)
+			return true;
+		
+		IEntity spawnedItem = SpawnLootEntity(info.GetResourceName());
+		
+		if(!spawnedItem)
+			return true;
+		
+		if(m_RandomizeManifestAmmo)
+			RandomizeAmmo(spawnedItem);
+		else
+			RestoreAmmo(spawnedItem, ammo);
+		
+		StoreItem(spawnedItem);
+		return true;
+	}
+	
 	static SCR_BaseGameMode s_GameMode;
 	static SCR_BaseGameMode GetGameMode()
 	{
@@ -126,31 +383,85 @@ class TW_LootableInventoryComponent : ScriptComponent
 	event override protected void OnDelete(IEntity owner)
 	{
 		TW_LootManager.UnregisterLootableContainer(this);
+		TW_LootManager.CancelQueuedLoot(this);
+		
+		if(m_HasBeenInteractedWith && m_Rpl && m_Rpl.IsMaster())
+			TW_LootManager.ReleaseInteractedContainer();
 	}
 	
 	bool InsertItem(TW_LootConfigItem item)
 	{
 		if(!item) return false;
 		
-		Resource prefabResource = Resource.Load(item.resourceName);
+		IEntity spawnedItem = SpawnLootEntity(item.resourceName);
 		
-		if(!prefabResource.IsValid())
+		if(!spawnedItem)
 		{
-			PrintFormat("TrainWreckLooting: Invalid Loot Resource: %1. Cannot spawn", item.resourceName, LogLevel.ERROR);
+			TW_LootManager.GetMetrics().OnItemInserted(false);
+			TraceInsert(item.resourceName, false);
 			return false;
 		}
 		
+		RandomizeAmmo(spawnedItem);
+		bool success = StoreItem(spawnedItem);
+		TW_LootManager.GetMetrics().OnItemInserted(success);
+		TraceInsert(item.resourceName, success);
+		return success;
+	}
+	
+	protected void TraceInsert(ResourceName resourceName, bool success)
+	{
+		if(!TW_LootTrace.IsEnabled())
+			return;
+		
+		if(success)
+			TW_LootTrace.Record(TW_LootTraceEvent.ItemSpawned, GetOwner().GetOrigin(), TW_LootManager.GetItemId(resourceName));
+		else
+			TW_LootTrace.Record(TW_LootTraceEvent.InsertFailed, GetOwner().GetOrigin(), TW_LootManager.GetItemId(resourceName));
+	}
+	
+	//! Reuse a parked entity of this prefab or spawn a new one at the container
+	protected IEntity SpawnLootEntity(ResourceName resourceName)
+	{
+		IEntity spawnedItem = TW_LootManager.TakeRecycledItem(resourceName);
+		
+		if(spawnedItem)
+		{
+			spawnedItem.SetOrigin(GetOwner().GetOrigin());
+			return spawnedItem;
+		}
+		
+		Resource prefabResource = TW_LootManager.GetPrefabResource(resourceName);
+		
+		if(!prefabResource)
+		{
+			PrintFormat("TrainWreckLooting: Invalid Loot Resource: %1. Cannot spawn", resourceName, LogLevel.ERROR);
+			TW_LootTrace.DumpOnError("invalid loot resource");
+			return null;
+		}
+		
 		EntitySpawnParams params = EntitySpawnParams();
 		GetOwner().GetTransform(params.Transform);
 		
-		IEntity spawnedItem = GetGame().SpawnEntityPrefab(prefabResource, GetGame().GetWorld(), params);
+		spawnedItem = GetGame().SpawnEntityPrefab(prefabResource, GetGame().GetWorld(), params);
 		
 		if(!spawnedItem)
 		{
-			PrintFormat("TrainWreckLooting: Was unable to spawn %1", item.resourceName, LogLevel.ERROR);
-			return false;
+			PrintFormat("TrainWreckLooting: Was unable to spawn %1", resourceName, LogLevel.ERROR);
+			TW_LootTrace.DumpOnError("loot spawn failed");
+			return null;
 		}
 		
+		// What Virtualize compares weapons against
+		TW_LootItemInfo info = TW_LootManager.GetItemInfo(resourceName);
+		if(info && info.HasWeapon())
+			info.RecordSpawnedChildren(spawnedItem);
+		
+		return spawnedItem;
+	}
+	
+	protected void RandomizeAmmo(IEntity spawnedItem)
+	{
 		BaseWeaponComponent weapon = BaseWeaponComponent.Cast(spawnedItem.FindComponent(BaseWeaponComponent));
 		
 		if(weapon)
@@ -183,13 +494,40 @@ class TW_LootableInventoryComponent : ScriptComponent
 				magazine.SetAmmoCount(Math.ClampInt(ammo, 0, maxAmmo));
 			}
 		}
+	}
+	
+	//! Put back the ammo recorded in a manifest. For weapons -1 means the magazine had been removed
+	protected void RestoreAmmo(IEntity spawnedItem, int ammo)
+	{
+		BaseWeaponComponent weapon = BaseWeaponComponent.Cast(spawnedItem.FindComponent(BaseWeaponComponent));
+		BaseMagazineComponent magazine;
 		
+		if(weapon)
+		{
+			magazine = weapon.GetCurrentMagazine();
+			
+			if(magazine && ammo < 0)
+			{
+				SCR_EntityHelper.DeleteEntityAndChildren(magazine.GetOwner());
+				return;
+			}
+		}
+		else
+			magazine = BaseMagazineComponent.Cast(spawnedItem.FindComponent(BaseMagazineComponent));
+		
+		if(magazine && ammo >= 0)
+			magazine.SetAmmoCount(Math.ClampInt(ammo, 0, magazine.GetMaxAmmoCount()));
+	}
+	
+	//! Insert into this container's storage. Items that do not fit are recycled or deleted
+	protected bool StoreItem(IEntity spawnedItem)
+	{
 		if(!m_StorageManager || !spawnedItem || !m_Storage)
 			return false;
 		
 		bool success = m_StorageManager.TryInsertItemInStorage(spawnedItem, m_Storage);
 		
-		if(!success)
+		if(!success && !TW_LootManager.RecycleItem(spawnedItem))
 			SCR_EntityHelper.DeleteEntityAndChildren(spawnedItem);
 		
 		return success;
@@ -1,7 +1,7 @@
 class WeightedPrefabs
 {
 	private ref array<string> m_Prefabs = {};
-	private ref array<float> m_Weights = {};
+	private ref TW_AliasSampler m_Sampler = new TW_AliasSampler();
 	
 	void AddConfigItem(TW_LootConfigItem item)
 	{
@@ -9,19 +9,33 @@ class WeightedPrefabs
 			return;
 		
 		m_Prefabs.Insert(item.resourceName);
-		m_Weights.Insert(item.chanceToSpawn);
+		m_Sampler.Add(item.chanceToSpawn);
 	}
 	
 	string GetRandomPrefab()
 	{
-		if(m_Prefabs.IsEmpty())
+		int index = m_Sampler.GetRandomIndex();
+		
+		if(index < 0)
 			return string.Empty;
 		
-		int index = SCR_ArrayHelper.GetWeightedIndex(m_Weights, Math.RandomFloat01());
 		return m_Prefabs.Get(index);
 	}
 }
 
+//! Where a clothing category ended up on a character prefab: one of the character's own storages and the slot in it
+class TW_LoadoutSlot
+{
+	int m_StorageIndex;
+	int m_SlotId;
+	
+	void TW_LoadoutSlot(int storageIndex, int slotId)
+	{
+		m_StorageIndex = storageIndex;
+		m_SlotId = slotId;
+	}
+}
+
 class TW_RandomInventoryComponentClass : ScriptComponentClass {};
 class TW_RandomInventoryComponent : ScriptComponent
 {
@@ -29,6 +43,7 @@ class TW_RandomInventoryComponent : ScriptComponent
 	private RplComponent m_RplComponent;
 	private SCR_CharacterControllerComponent m_Controller;
 	private SCR_InventoryStorageManagerComponent m_StorageManager;
+	private ref array<BaseInventoryStorageComponent> m_OwnStorages;
 	
 	private static ref WeightedPrefabs m_WeaponPrefabs;
 	private static ref WeightedPrefabs m_VestPrefabs;
@@ -41,6 +56,25 @@ class TW_RandomInventoryComponent : ScriptComponent
 	
 	private static bool Initialized = false;
 	
+	// Characters waiting for a loadout in spawn order, with the world time each becomes ready
+	private static ref array<TW_RandomInventoryComponent> s_LoadoutQueue = {};
+	private static ref array<float> s_LoadoutReadyTimes = {};
+	private static int s_LoadoutQueueHead;
+	private static bool s_IsLoadoutQueueRunning;
+	
+	// Give the character's default loadout time to spawn before it is replaced
+	private static const int LOADOUT_DELAY_MS = 1000;
+	
+	private static const SCR_EArsenalItemType WEAPON_TYPES = SCR_EArsenalItemType.RIFLE | SCR_EArsenalItemType.MACHINE_GUN | SCR_EArsenalItemType.SNIPER_RIFLE | SCR_EArsenalItemType.PISTOL;
+	
+	// Loadouts rolled ahead of time during idle frames
+	private static ref array<ref TW_ScavLoadoutTemplate> s_LoadoutTemplates = {};
+	private static int s_NextLoadoutTemplateId;
+	private static bool s_IsTemplateRefillRunning;
+	
+	// Character prefab -> item type mask -> slot clothing of that type was inserted into
+	private static ref map<ResourceName, ref map<int, ref TW_LoadoutSlot>> s_LoadoutSlots = new map<ResourceName, ref map<int, ref TW_LoadoutSlot>>();
+	
 	override void OnPostInit(IEntity owner)
 	{
 		if(!GetGame().InPlayMode())
@@ -53,10 +87,93 @@ class TW_RandomInventoryComponent : ScriptComponent
 		m_RplComponent = TW<RplComponent>.Find(owner);
 		m_Controller = TW<SCR_CharacterControllerComponent>.Find(owner);
 		m_StorageManager = TW<SCR_InventoryStorageManagerComponent>.Find(GetOwner());	
-		GetGame().GetCallqueue().CallLater(InitializeLoadout, 1000, false);
+		EnqueueLoadout(this);
 	}
 	
-	private void InitializeType(SCR_EArsenalTypes type, out WeightedPrefabs entry, string hasComponent = string.Empty)
+	private static void EnqueueLoadout(TW_RandomInventoryComponent component)
+	{
+		s_LoadoutQueue.Insert(component);
+		s_LoadoutReadyTimes.Insert(GetGame().GetWorld().GetWorldTime() + LOADOUT_DELAY_MS);
+		
+		if(s_IsLoadoutQueueRunning)
+			return;
+		
+		s_IsLoadoutQueueRunning = true;
+		GetGame().GetCallqueue().CallLater(ProcessLoadoutQueue, 0, true);
+	}
+	
+	//! Hand out queued loadouts within the per-frame limits of ScavLootSettings
+	private static void ProcessLoadoutQueue()
+	{
+		TW_LootManager manager = TW_LootManager.GetInstance();
+		
+		// Loot table is not ready yet
+		if(!manager || !manager.GetLootSettings())
+			return;
+		
+		ScavLootSettings settings = manager.GetScavSettings();
+		float now = GetGame().GetWorld().GetWorldTime();
+		int startTick = System.GetTickCount();
+		int served = 0;
+		int count = s_LoadoutQueue.Count();
+		
+		while(s_LoadoutQueueHead < count && served < settings.loadoutsPerFrame && System.GetTickCount() - startTick < settings.loadoutFrameBudgetMs)
+		{
+			// Entries are in spawn order, so nothing behind this one is ready either
+			if(s_LoadoutReadyTimes.Get(s_LoadoutQueueHead) > now)
+				break;
+			
+			TW_RandomInventoryComponent component = s_LoadoutQueue.Get(s_LoadoutQueueHead);
+			s_LoadoutQueueHead++;
+			
+			// Character was deleted while it waited
+			if(!component)
+				continue;
+			
+			component.InitializeLoadout();
+			served++;
+		}
+		
+		if(served > 0)
+			TW_LootManager.GetMetrics().RecordTime(TW_LootSubsystem.Loadout, System.GetTickCount() - startTick);
+		
+		CompactLoadoutQueue();
+	}
+	
+	//! Drop served entries, stopping the queue once it is empty
+	private static void CompactLoadoutQueue()
+	{
+		int count = s_LoadoutQueue.Count();
+		
+		if(s_LoadoutQueueHead >= count)
+		{
+			s_LoadoutQueue.Clear();
+			s_LoadoutReadyTimes.Clear();
+			s_LoadoutQueueHead = 0;
+			s_IsLoadoutQueueRunning = false;
+			GetGame().GetCallqueue().Remove(ProcessLoadoutQueue);
+			return;
+		}
+		
+		// Only shift the arrays once the served part dominates
+		if(s_LoadoutQueueHead < 32 || s_LoadoutQueueHead * 2 < count)
+			return;
+		
+		ref array<TW_RandomInventoryComponent> remaining = {};
+		ref array<float> remainingTimes = {};
+		
+		for(int i = s_LoadoutQueueHead; i < count; i++)
+		{
+			remaining.Insert(s_LoadoutQueue.Get(i));
+			remainingTimes.Insert(s_LoadoutReadyTimes.Get(i));
+		}
+		
+		s_LoadoutQueue = remaining;
+		s_LoadoutReadyTimes = remainingTimes;
+		s_LoadoutQueueHead = 0;
+	}
+	
+	private static void InitializeType(SCR_EArsenalTypes type, out WeightedPrefabs entry, string hasComponent = string.Empty)
 	{
 		entry = new WeightedPrefabs();
 		ref array<ref TW_LootConfigItem> configs = {};
@@ -69,7 +186,7 @@ class TW_RandomInventoryComponent : ScriptComponent
 			entry.AddConfigItem(config);
 	}
 	
-	private void InitializeWeightSystem()
+	private static void InitializeWeightSystem()
 	{
 		ref array<ref TW_LootConfigItem> weapons = {};
 		int weaponCount = TW_LootManager.GetWeapons(weapons);
@@ -80,7 +197,7 @@ class TW_RandomInventoryComponent : ScriptComponent
 			return;
 		}
 		
-		InitializeType(SCR_EArsenalItemType.RIFLE | SCR_EArsenalItemType.MACHINE_GUN | SCR_EArsenalItemType.SNIPER_RIFLE | SCR_EArsenalItemType.PISTOL, m_WeaponPrefabs, "WeaponComponent");
+		InitializeType(WEAPON_TYPES, m_WeaponPrefabs, "WeaponComponent");
 		InitializeType(SCR_EArsenalItemType.HEADWEAR, m_HeadwearPrefabs);
 		InitializeType(SCR_EArsenalItemType.TORSO, m_ShirtPrefabs);
 		InitializeType(SCR_EArsenalItemType.LEGS, m_PantsPrefabs);
@@ -90,6 +207,122 @@ class TW_RandomInventoryComponent : ScriptComponent
 		InitializeType(SCR_EArsenalItemType.HEAL, m_HealPrefabs);
 		
 		Initialized = true;
+		StartTemplateRefill();
+	}
+	
+	//! Roll a complete loadout from the weighted prefab lists
+	private static TW_ScavLoadoutTemplate RollLoadoutTemplate()
+	{
+		ScavLootSettings settings = TW_LootManager.GetInstance().GetScavSettings();
+		TW_ScavLoadoutTemplate template = new TW_ScavLoadoutTemplate(s_NextLoadoutTemplateId);
+		s_NextLoadoutTemplateId++;
+		
+		template.AddPrefab(m_PantsPrefabs.GetRandomPrefab());
+		template.AddPrefab(m_HeadwearPrefabs.GetRandomPrefab());
+		template.AddPrefab(m_FootwearPrefabs.GetRandomPrefab());
+		template.AddPrefab(m_ShirtPrefabs.GetRandomPrefab());
+		
+		if(Math.RandomFloat01() < settings.spawnWithBackpackChance)
+			template.AddPrefab(m_BackpackPrefabs.GetRandomPrefab(), EStoragePurpose.PURPOSE_LOADOUT_PROXY);
+		
+		if(Math.RandomFloat01() < settings.spawnWithVestChance)
+			template.AddPrefab(m_VestPrefabs.GetRandomPrefab(), EStoragePurpose.PURPOSE_LOADOUT_PROXY);
+		
+		if(Math.RandomFloat01() < settings.spawnWithHealChance)
+		{
+			int healCount = Math.RandomIntInclusive(0, 3);
+			for(int i = 0; i < healCount; i++)
+				template.AddPrefab(m_HealPrefabs.GetRandomPrefab());
+		}
+		
+		template.AddWeapon(m_WeaponPrefabs.GetRandomPrefab(), Math.RandomIntInclusive(0, 3));
+		
+		if(Math.RandomFloat01() < settings.spawnWithTwoWeaponsChance)
+			template.AddWeapon(m_WeaponPrefabs.GetRandomPrefab(), Math.RandomIntInclusive(0, 3));
+		
+		return template;
+	}
+	
+	//! Take a pre-rolled loadout, rolling one on the spot if the pool ran dry
+	private static TW_ScavLoadoutTemplate TakeLoadoutTemplate()
+	{
+		TW_ScavLoadoutTemplate template;
+		int count = s_LoadoutTemplates.Count();
+		
+		if(count > 0)
+		{
+			template = s_LoadoutTemplates.Get(count - 1);
+			s_LoadoutTemplates.Remove(count - 1);
+		}
+		else
+			template = RollLoadoutTemplate();
+		
+		StartTemplateRefill();
+		return template;
+	}
+	
+	private static void StartTemplateRefill()
+	{
+		if(s_IsTemplateRefillRunning)
+			return;
+		
+		s_IsTemplateRefillRunning = true;
+		GetGame().GetCallqueue().CallLater(RefillLoadoutTemplates, 0, true);
+	}
+	
+	//! Roll at most one template per frame, only while the shared loot frame budget has room
+	private static void RefillLoadoutTemplates()
+	{
+		TW_LootManager manager = TW_LootManager.GetInstance();
+		
+		if(!manager || !manager.GetLootSettings() || !Initialized)
+			return;
+		
+		if(s_LoadoutTemplates.Count() >= manager.GetScavSettings().loadoutTemplatePoolSize)
+		{
+			s_IsTemplateRefillRunning = false;
+			GetGame().GetCallqueue().Remove(RefillLoadoutTemplates);
+			return;
+		}
+		
+		TW_LootFrameBudget budget = TW_LootManager.GetFrameBudget();
+		budget.Begin();
+		
+		if(budget.HasBudget())
+		{
+			s_LoadoutTemplates.Insert(RollLoadoutTemplate());
+			budget.Consume();
+		}
+		
+		budget.End();
+	}
+	
+	//! Rebuild the weighted lists drawing from changed arsenal types and drop every pre-rolled loadout
+	static void OnLootTableChanged(SCR_EArsenalItemType changedTypes)
+	{
+		s_LoadoutTemplates.Clear();
+		
+		if(!Initialized)
+			return;
+		
+		if(changedTypes & WEAPON_TYPES)
+			InitializeType(WEAPON_TYPES, m_WeaponPrefabs, "WeaponComponent");
+		if(changedTypes & SCR_EArsenalItemType.HEADWEAR)
+			InitializeType(SCR_EArsenalItemType.HEADWEAR, m_HeadwearPrefabs);
+		if(changedTypes & SCR_EArsenalItemType.TORSO)
+			InitializeType(SCR_EArsenalItemType.TORSO, m_ShirtPrefabs);
+		if(changedTypes & SCR_EArsenalItemType.LEGS)
+			InitializeType(SCR_EArsenalItemType.LEGS, m_PantsPrefabs);
+		if(changedTypes & SCR_EArsenalItemType.FOOTWEAR)
+			InitializeType(SCR_EArsenalItemType.FOOTWEAR, m_FootwearPrefabs);
+		if(changedTypes & SCR_EArsenalItemType.BACKPACK)
+			InitializeType(SCR_EArsenalItemType.BACKPACK, m_BackpackPrefabs);
+		if(changedTypes & SCR_EArsenalItemType.VEST_AND_WAIST)
+			InitializeType(SCR_EArsenalItemType.VEST_AND_WAIST, m_VestPrefabs);
+		if(changedTypes & SCR_EArsenalItemType.HEAL)
+			InitializeType(SCR_EArsenalItemType.HEAL, m_HealPrefabs);
+		
+		StartTemplateRefill();
 	}
 	
 	private bool SpawnEquipment(ResourceName prefab)
@@ -100,48 +333,159 @@ class TW_RandomInventoryComponent : ScriptComponent
 		return m_StorageManager.TrySpawnPrefabToStorage(prefab, purpose: EStoragePurpose.PURPOSE_LOADOUT_PROXY);
 	}
 	
-	private bool SpawnItem(ResourceName prefab)
+	//! Storages on the character entity itself, in component order. Same for every instance of a prefab
+	private array<BaseInventoryStorageComponent> GetOwnStorages()
 	{
-		return m_StorageManager.TrySpawnPrefabToStorage(prefab, purpose: EStoragePurpose.PURPOSE_DEPOSIT);
+		if(m_OwnStorages)
+			return m_OwnStorages;
+		
+		m_OwnStorages = {};
+		ref array<Managed> components = {};
+		GetOwner().FindComponents(BaseInventoryStorageComponent, components);
+		
+		foreach(Managed component : components)
+			m_OwnStorages.Insert(BaseInventoryStorageComponent.Cast(component));
+		
+		return m_OwnStorages;
+	}
+	
+	private map<int, ref TW_LoadoutSlot> GetLoadoutSlots()
+	{
+		ResourceName characterPrefab;
+		EntityPrefabData prefabData = GetOwner().GetPrefabData();
+		
+		if(prefabData)
+			characterPrefab = prefabData.GetPrefabName();
+		
+		map<int, ref TW_LoadoutSlot> slots = s_LoadoutSlots.Get(characterPrefab);
+		
+		if(!slots)
+		{
+			slots = new map<int, ref TW_LoadoutSlot>();
+			s_LoadoutSlots.Set(characterPrefab, slots);
+		}
+		
+		return slots;
 	}
 	
-	private ResourceName GetMagazineFromWeapon(ResourceName weaponPrefab)
+	//! Spawn a loadout prefab. Clothing goes straight into the slot cached for its type on this character prefab,
+	//! everything else (and clothing without a cached slot yet) goes through the generic storage search
+	private bool SpawnLoadoutPrefab(ResourceName prefab, EStoragePurpose purpose)
 	{
+		TW_LootItemInfo info = TW_LootManager.GetItemInfo(prefab);
+		
+		if(!info || info.GetStoragePurpose() != EStoragePurpose.PURPOSE_LOADOUT_PROXY)
+			return m_StorageManager.TrySpawnPrefabToStorage(prefab, purpose: purpose);
+		
+		Resource resource = TW_LootManager.GetPrefabResource(prefab);
+		
+		if(!resource)
+			return false;
+		
 		EntitySpawnParams params = EntitySpawnParams();
-		m_StorageManager.GetOwner().GetTransform(params.Transform);
+		GetOwner().GetTransform(params.Transform);
 		
-		Resource weaponResource = Resource.Load(weaponPrefab);
+		IEntity item = GetGame().SpawnEntityPrefab(resource, GetGame().GetWorld(), params);
 		
-		if(!weaponResource.IsValid())
-			return ResourceName.Empty;
+		if(!item)
+			return false;
 		
-		IEntity weapon = GetGame().SpawnEntityPrefab(weaponResource, GetGame().GetWorld(), params);
+		array<BaseInventoryStorageComponent> storages = GetOwnStorages();
+		map<int, ref TW_LoadoutSlot> slots = GetLoadoutSlots();
+		int category = info.GetTypeMask();
+		TW_LoadoutSlot cached = slots.Get(category);
 		
-		if(!weapon)
+		if(cached)
 		{
-			PrintFormat("TrainWreckLootingSystem: Was unable to spawn weapon %1", weaponPrefab, LogLevel.WARNING);
-			return ResourceName.Empty;
+			if(storages.IsIndexValid(cached.m_StorageIndex) && m_StorageManager.TryInsertItemInStorage(item, storages.Get(cached.m_StorageIndex), cached.m_SlotId))
+				return true;
+			
+			// Slot did not fit this item, learn it again below
+			slots.Remove(category);
 		}
 		
-		WeaponComponent weaponComp = TW<WeaponComponent>.Find(weapon);
-		BaseMagazineComponent comp = weaponComp.GetCurrentMagazine();
+		BaseInventoryStorageComponent storage = m_StorageManager.FindStorageForItem(item, purpose);
+		int storageIndex = -1;
+		
+		if(storage)
+			storageIndex = storages.Find(storage);
+		
+		// Only slots on the character itself are the same for every instance of the prefab
+		if(storageIndex != -1)
+		{
+			InventoryStorageSlot slot = storage.FindSuitableSlotForItem(item);
+			
+			if(slot && m_StorageManager.TryInsertItemInStorage(item, storage, slot.GetID()))
+			{
+				slots.Set(category, new TW_LoadoutSlot(storageIndex, slot.GetID()));
+				return true;
+			}
+		}
+		
+		if(m_StorageManager.TryInsertItem(item, purpose))
+			return true;
+		
+		SCR_EntityHelper.DeleteEntityAndChildren(item);
+		return false;
+	}
+	
+	private bool SpawnItem(ResourceName prefab)
+	{
+		return m_StorageManager.TrySpawnPrefabToStorage(prefab, purpose: EStoragePurpose.PURPOSE_DEPOSIT);
+	}
+	
+	//! Spawn the weapon and put it in the character's hands
+	private bool SpawnWeapon(ResourceName weaponPrefab)
+	{
+		Resource weaponResource = TW_LootManager.GetPrefabResource(weaponPrefab);
+		
+		if(!weaponResource)
+			return false;
+		
+		EntitySpawnParams params = EntitySpawnParams();
+		m_StorageManager.GetOwner().GetTransform(params.Transform);
+		
+		IEntity weapon = GetGame().SpawnEntityPrefab(weaponResource, GetGame().GetWorld(), params);
 		
-		if(!comp)
+		if(!weapon)
 		{
-			PrintFormat("TrainWreckLootingSystem: Weapon does not have weapon component %1", weaponPrefab, LogLevel.WARNING);
-			return ResourceName.Empty;
+			PrintFormat("TrainWreckLootingSystem: Was unable to spawn weapon %1", weaponPrefab, LogLevel.WARNING);
+			return false;
 		}
 		
 		if(!m_StorageManager.TryInsertItem(weapon, EStoragePurpose.PURPOSE_WEAPON_PROXY))
 		{
 			PrintFormat("TrainWreckLootingSystem: Was unable to insert weapon: %1", weaponPrefab, LogLevel.WARNING);
-			return ResourceName.Empty;
+			SCR_EntityHelper.DeleteEntityAndChildren(weapon);
+			return false;
 		}
 		
 		if(m_Controller)
 			m_Controller.TryEquipRightHandItem(weapon, EEquipItemType.EEquipTypeWeapon);
 		
-		return comp.GetOwner().GetPrefabData().GetPrefabName();
+		return true;
+	}
+	
+	//! Spawn a weapon plus a few of its magazines. The magazine comes from the loot manager's prefab index, not the spawned weapon
+	private bool SpawnWeaponWithMagazines(ResourceName weaponPrefab, int magazineCount)
+	{
+		if(weaponPrefab == ResourceName.Empty || !SpawnWeapon(weaponPrefab))
+			return false;
+		
+		ResourceName magazinePrefab = TW_LootManager.GetDefaultMagazine(weaponPrefab);
+		
+		if(magazinePrefab == ResourceName.Empty)
+		{
+			PrintFormat("TrainWreckLootingSystem: Weapon does not have a default magazine %1", weaponPrefab, LogLevel.WARNING);
+			return false;
+		}
+		
+		for(int i = 0; i < magazineCount; i++)
+		{
+			SpawnItem(magazinePrefab);
+		}
+		
+		return true;
 	}
 	
 	private void InitializeLoadout()
@@ -158,6 +502,9 @@ class TW_RandomInventoryComponent : ScriptComponent
 		if(!Initialized)
 			InitializeWeightSystem();
 		
+		if(!Initialized)
+			return;
+		
 		ref array<IEntity> entities = {};
 		m_StorageManager.GetItems(entities);
 		
@@ -166,70 +513,20 @@ class TW_RandomInventoryComponent : ScriptComponent
 		entities.Clear();
 		delete entities;
 		
-		ResourceName pantsPrefab = m_PantsPrefabs.GetRandomPrefab();
-		ResourceName headwearPrefab = m_HeadwearPrefabs.GetRandomPrefab();
-		ResourceName footwearPrefab = m_FootwearPrefabs.GetRandomPrefab();
-		ResourceName shirtPrefab = m_ShirtPrefabs.GetRandomPrefab();
+		TW_ScavLoadoutTemplate template = TakeLoadoutTemplate();
 		
-		if(pantsPrefab) m_StorageManager.TrySpawnPrefabToStorage(pantsPrefab);
-		if(headwearPrefab) m_StorageManager.TrySpawnPrefabToStorage(headwearPrefab);
-		if(footwearPrefab) m_StorageManager.TrySpawnPrefabToStorage(footwearPrefab);
-		if(shirtPrefab) m_StorageManager.TrySpawnPrefabToStorage(shirtPrefab);
+		TW_LootTrace.Record(TW_LootTraceEvent.LoadoutApplied, GetOwner().GetOrigin(), template.GetId());
 		
-		if(Math.RandomFloat01() < TW_LootManager.GetInstance().GetScavSettings().spawnWithBackpackChance)
-		{
-			ResourceName backpackPrefab = m_BackpackPrefabs.GetRandomPrefab();
-			
-			if(backpackPrefab != string.Empty)
-			{
-				m_StorageManager.TrySpawnPrefabToStorage(backpackPrefab, purpose: EStoragePurpose.PURPOSE_LOADOUT_PROXY);
-			}
-		}
-		
-		if(Math.RandomFloat01() < TW_LootManager.GetInstance().GetScavSettings().spawnWithVestChance)
-		{
-			ResourceName vestPrefab = m_VestPrefabs.GetRandomPrefab();
-			if(vestPrefab != string.Empty)
-				m_StorageManager.TrySpawnPrefabToStorage(vestPrefab, purpose: EStoragePurpose.PURPOSE_LOADOUT_PROXY);
-		}				
+		int prefabCount = template.GetPrefabCount();
+		for(int i = 0; i < prefabCount; i++)
+			SpawnLoadoutPrefab(template.GetPrefab(i), template.GetPurpose(i));
 		
-		if(Math.RandomFloat01() < TW_LootManager.GetInstance().GetScavSettings().spawnWithHealChance)
+		int weaponCount = template.GetWeaponCount();
+		for(int weaponIndex = 0; weaponIndex < weaponCount; weaponIndex++)
 		{
-			int healCount = Math.RandomIntInclusive(0, 3);
-			for(int i = 0; i < healCount; i++)
-			{
-				ResourceName healPrefab = m_HealPrefabs.GetRandomPrefab();
-				if(healPrefab == string.Empty)
-					continue;
-				m_StorageManager.TrySpawnPrefabToStorage(healPrefab);
-			}
-		}
-				
-		ResourceName weaponPrefab = m_WeaponPrefabs.GetRandomPrefab();		
-		ResourceName magazinePrefab = GetMagazineFromWeapon(weaponPrefab);
-		
-		if(magazinePrefab == ResourceName.Empty)
-			return;
-		
-		int count = Math.RandomIntInclusive(0, 3);
-		for(int i = 0; i < count; i++)
-		{
-			SpawnItem(magazinePrefab);
-		}
-		
-		if(Math.RandomFloat01() < TW_LootManager.GetInstance().GetScavSettings().spawnWithTwoWeaponsChance)
-		{
-			weaponPrefab = m_WeaponPrefabs.GetRandomPrefab();		
-			magazinePrefab = GetMagazineFromWeapon(weaponPrefab);
-			
-			if(magazinePrefab == ResourceName.Empty)
+			// Without a primary there is no point in trying the second weapon
+			if(!SpawnWeaponWithMagazines(template.GetWeapon(weaponIndex), template.GetMagazineCount(weaponIndex)))
 				return;
-			
-			count = Math.RandomIntInclusive(0, 3);
-			for(int i = 0; i < count; i++)
-			{
-				SpawnItem(magazinePrefab);
-			}	
 		}
 	}
 };
\ No newline at end of file
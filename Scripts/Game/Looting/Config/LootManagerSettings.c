@@ -11,6 +11,20 @@ class LootRespawnSettings
 	int GridSize;
 	int DeadZoneRadius;
 	
+	//! Script time per frame the loot spawn and respawn paths may use
+	float FrameBudgetMs;
+	
+	//! Server frame time above which batch sizes shrink
+	float TargetFrameTimeMs;
+	int MinBatchSize;
+	int MaxBatchSize;
+	
+	//! Delay between items trickling into a searched container
+	int TrickleSpawnDelayMs;
+	
+	//! Most loot items spawned per frame across all containers
+	int MaxSpawnsPerFrame;
+	
 	void LootRespawnSettings()
 	{
 		RespawnLootRadius = 5;
@@ -22,6 +36,12 @@ class LootRespawnSettings
 		SearchedTimeRatio = 0.0;
 		GridSize = 100;
 		DeadZoneRadius = 2;
+		FrameBudgetMs = 2;
+		TargetFrameTimeMs = 33;
+		MinBatchSize = 2;
+		MaxBatchSize = 50;
+		TrickleSpawnDelayMs = 250;
+		MaxSpawnsPerFrame = 4;
 	}
 };
 
@@ -31,6 +51,45 @@ class LootManagerSettings
 	bool IsLootEnabled;
 	bool ShowDebug;
 	
+	//! Number of highest weighted loot prefabs to load at map start (0 disables preloading)
+	int PreloadTopWeightedItems;
+	
+	//! Loot entities kept parked for reuse instead of being deleted (0 disables recycling)
+	int MaxRecycledItems;
+	int MaxRecycledItemsPerPrefab;
+	
+	//! Turn idle searched containers away from players back into data, spawning entities again when opened.
+	//! Runs inside the respawn processor and uses its player tracking, so it needs RespawnSettings.IsLootRespawnable
+	bool UseVirtualLoot;
+	int VirtualizeAfterIdleSeconds;
+	
+	//! How often searched containers and their respawn timers are saved to $profile:lootstate.json and restored on restart (0 disables)
+	int LootStateSaveIntervalSeconds;
+	
+	//! How often loot metrics are appended to $profile:lootmetrics.csv (0 disables the dump, the metrics command still works).
+	//! Off by default, the file grows for as long as the dump runs
+	int MetricsDumpIntervalSeconds;
+	
+	//! Loot events kept in the trace ring buffer, dumped to $profile:loottrace.csv by the trace command (0 disables tracing)
+	int TraceCapacity;
+	
+	//! Dump the trace buffer when loot fails to spawn
+	bool DumpTraceOnError;
+	
+	//! Write lootmap.json without indentation. Only written when new catalog items were merged in
+	bool WriteCompactLootTable;
+	
+	//! Pre-roll the loot of unsearched containers as players come within RespawnLootRadius, using spare frame budget.
+	//! Searching a prewarmed container shows its items at once instead of trickling them in. Needs IsLootRespawnable for player tracking
+	bool PrewarmLootNearPlayers;
+	
+	//! Also spawn the pre-rolled entities into the container ahead of the search.
+	//! Staged entities are cleared again shortly after every player has left RespawnLootRadius of the container
+	bool PrewarmStageEntities;
+	
+	//! How often $profile:lootcommands.txt is checked for admin commands such as "reload" (0 disables commands)
+	int CommandPollIntervalSeconds;
+	
 	ref LootRespawnSettings RespawnSettings;
 	ref PercentageFieldSetting AmmoPercentageSetting;
 	ref ScavLootSettings ScavSettings;
@@ -41,6 +100,15 @@ class LootManagerSettings
 	{
 		ShouldSpawnMagazine = true;
 		IsLootEnabled = true;
+		MaxRecycledItems = 200;
+		MaxRecycledItemsPerPrefab = 20;
+		UseVirtualLoot = false;
+		VirtualizeAfterIdleSeconds = 300;
+		CommandPollIntervalSeconds = 5;
+		LootStateSaveIntervalSeconds = 300;
+		MetricsDumpIntervalSeconds = 0;
+		TraceCapacity = 4096;
+		DumpTraceOnError = true;
 		RespawnSettings = new LootRespawnSettings();
 		ScavSettings = new ScavLootSettings();
 		AmmoPercentageSetting = new PercentageFieldSetting();
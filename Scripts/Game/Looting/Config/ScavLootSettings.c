@@ -4,4 +4,13 @@ class ScavLootSettings
 	float spawnWithTwoWeaponsChance = 0.1;
 	float spawnWithHealChance = 0.25;
 	float spawnWithVestChance = 0.3;
+	
+	// Scav loadouts are handed out from a queue, at most this many per frame
+	int loadoutsPerFrame = 1;
+	
+	// Script time per frame the loadout queue may use
+	float loadoutFrameBudgetMs = 2;
+	
+	// Loadouts kept pre-rolled in the background, so spawning a scav only applies one
+	int loadoutTemplatePoolSize = 16;
 };
\ No newline at end of file
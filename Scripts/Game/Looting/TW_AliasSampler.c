@@ -0,0 +1,113 @@
+/*
+	Constant time weighted index sampler (Vose's alias method).
+	
+	Building the table is O(n) and happens once after the weights change,
+	every draw afterwards costs one random column plus one coin flip.
+*/
+class TW_AliasSampler
+{
+	protected ref array<float> m_Weights = {};
+	protected ref array<float> m_Probabilities = {};
+	protected ref array<int> m_Aliases = {};
+	protected float m_TotalWeight;
+	protected bool m_IsDirty;
+	
+	int Count() { return m_Weights.Count(); }
+	bool IsEmpty() { return m_Weights.IsEmpty(); }
+	float GetTotalWeight() { return m_TotalWeight; }
+	
+	//! Add a weight, returns the index that will be drawn for it
+	int Add(float weight)
+	{
+		m_IsDirty = true;
+		
+		if(weight < 0)
+			weight = 0;
+		
+		return m_Weights.Insert(weight);
+	}
+	
+	void Clear()
+	{
+		m_Weights.Clear();
+		m_Probabilities.Clear();
+		m_Aliases.Clear();
+		m_TotalWeight = 0;
+		m_IsDirty = false;
+	}
+	
+	//! Rebuild the alias table from the current weights
+	void Build()
+	{
+		m_IsDirty = false;
+		m_Probabilities.Clear();
+		m_Aliases.Clear();
+		m_TotalWeight = 0;
+		
+		int count = m_Weights.Count();
+		
+		foreach(float weight : m_Weights)
+			m_TotalWeight += weight;
+		
+		if(count == 0 || m_TotalWeight <= 0)
+			return;
+		
+		ref array<float> scaled = {};
+		ref array<int> small = {};
+		ref array<int> large = {};
+		
+		for(int i = 0; i < count; i++)
+		{
+			float probability = m_Weights.Get(i) * count / m_TotalWeight;
+			scaled.Insert(probability);
+			
+			// Leftover columns keep these defaults: always pick themselves
+			m_Probabilities.Insert(1);
+			m_Aliases.Insert(i);
+			
+			if(probability < 1)
+				small.Insert(i);
+			else
+				large.Insert(i);
+		}
+		
+		while(!small.IsEmpty() && !large.IsEmpty())
+		{
+			int less = small.Get(small.Count() - 1);
+			small.Remove(small.Count() - 1);
+			
+			int more = large.Get(large.Count() - 1);
+			large.Remove(large.Count() - 1);
+			
+			m_Probabilities.Set(less, scaled.Get(less));
+			m_Aliases.Set(less, more);
+			
+			float remaining = (scaled.Get(more) + scaled.Get(less)) - 1;
+			scaled.Set(more, remaining);
+			
+			if(remaining < 1)
+				small.Insert(more);
+			else
+				large.Insert(more);
+		}
+	}
+	
+	//! Weighted random index, or -1 when there is nothing to draw from
+	int GetRandomIndex()
+	{
+		if(m_IsDirty)
+			Build();
+		
+		int count = m_Probabilities.Count();
+		
+		if(count == 0)
+			return -1;
+		
+		int column = Math.RandomInt(0, count);
+		
+		if(Math.RandomFloat01() < m_Probabilities.Get(column))
+			return column;
+		
+		return m_Aliases.Get(column);
+	}
+};
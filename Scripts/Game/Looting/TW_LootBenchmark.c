@@ -0,0 +1,230 @@
+/*
+	Microbenchmarks for the loot hot paths.
+	
+	Installs a synthetic loot table of the requested size, times a fixed number
+	of calls to each path and prints ops/sec and microseconds per call, then puts
+	the live table back. Runs from the "benchmark" loot command on a server with
+	no players connected, or from the TrainWreck Loot Benchmark plugin in the
+	World Editor.
+	
+	System.GetTickCount only has millisecond resolution, so iteration counts
+	should be large enough for every path to take tens of milliseconds.
+*/
+class TW_LootBenchmark
+{
+	static const int DEFAULT_ITEM_COUNT = 1000;
+	static const int DEFAULT_ITERATIONS = 100000;
+	
+	//! Default for the server command, where the whole run happens within one frame
+	static const int SERVER_DEFAULT_ITERATIONS = 1000;
+	
+	// Draws per SelectRandomPrefabsFromFlags call, about what a loot action asks for
+	protected static const int SELECT_COUNT = 5;
+	
+	// Arsenal types a typical container draws from
+	protected static const SCR_EArsenalItemType CONTAINER_FLAGS = SCR_EArsenalItemType.RIFLE | SCR_EArsenalItemType.HEAL | SCR_EArsenalItemType.TORSO | SCR_EArsenalItemType.LEGS | SCR_EArsenalItemType.FOOTWEAR;
+	
+	// Synthetic respawn set: one container per item spread over this many grid cells, every BLOCKED_CELL_STRIDE-th cell has a player nearby
+	protected static const int RESPAWN_CELL_COUNT = 256;
+	protected static const int BLOCKED_CELL_STRIDE = 16;
+	
+	// Respawn delay of the synthetic containers and the processor's check interval, in seconds
+	protected static const int RESPAWN_SECONDS = 1800;
+	protected static const int RESPAWN_CHECK_SECONDS = 30;
+	
+	protected int m_ItemCount;
+	protected int m_Iterations;
+	
+	protected ref array<ref TW_LootConfigItem> m_Items = {};
+	protected ref array<SCR_EArsenalItemType> m_Types = {};
+	
+	// Only created when the benchmark runs without a game, e.g. in Workbench
+	protected ref TW_LootManager m_OwnManager;
+	
+	void TW_LootBenchmark(int itemCount = DEFAULT_ITEM_COUNT, int iterations = DEFAULT_ITERATIONS)
+	{
+		m_ItemCount = Math.Max(1, itemCount);
+		m_Iterations = Math.Max(1, iterations);
+	}
+	
+	void Run()
+	{
+		TW_LootManager manager = TW_LootManager.GetInstance();
+		
+		if(!manager)
+		{
+			m_OwnManager = new TW_LootManager();
+			manager = m_OwnManager;
+		}
+		
+		BuildSyntheticTable();
+		
+		if(!TW_LootManager.InstallSyntheticLootTable(m_Items, m_Types))
+		{
+			Print("TrainWreck: Benchmark is already running", LogLevel.WARNING);
+			return;
+		}
+		
+		PrintFormat("TrainWreck: Loot benchmark, %1 synthetic items, %2 iterations per path", m_ItemCount, m_Iterations);
+		
+		BenchmarkPoolLookup();
+		BenchmarkPoolDraw();
+		BenchmarkSelectFromFlags(manager);
+		BenchmarkFlagHasResource();
+		BenchmarkRespawnProcessing();
+		BenchmarkWeightedPrefabs();
+		
+		TW_LootManager.RestoreLootTable();
+	}
+	
+	//! Items spread evenly over the arsenal types with random weights
+	protected void BuildSyntheticTable()
+	{
+		m_Items.Clear();
+		m_Types.Clear();
+		
+		ref array<SCR_EArsenalItemType> arsenalTypes = {};
+		SCR_Enum.GetEnumValues(SCR_EArsenalItemType, arsenalTypes);
+		
+		for(int i = 0; i < m_ItemCount; i++)
+		{
+			TW_LootConfigItem item = new TW_LootConfigItem();
+			item.SetData(string.Format("{0000000000000000}Prefabs/TrainWreckBenchmark/Item_%1.et", i), Math.RandomIntInclusive(1, 100), Math.RandomIntInclusive(1, 4));
+			
+			m_Items.Insert(item);
+			m_Types.Insert(arsenalTypes.Get(i % arsenalTypes.Count()));
+		}
+	}
+	
+	protected void Report(string path, int calls, int elapsedMs)
+	{
+		if(elapsedMs <= 0)
+		{
+			PrintFormat("TrainWreck: Benchmark %1: under 1ms for %2 calls, raise the iteration count", path, calls);
+			return;
+		}
+		
+		float opsPerSecond = calls * 1000.0 / elapsedMs;
+		float microsecondsPerCall = elapsedMs * 1000.0 / calls;
+		PrintFormat("TrainWreck: Benchmark %1: %2 ops/sec, %3 us/call (%4 calls in %5ms)", path, opsPerSecond, microsecondsPerCall, calls, elapsedMs);
+	}
+	
+	//! Cached lookup, as done for every loot roll
+	protected void BenchmarkPoolLookup()
+	{
+		TW_LootManager.GetLootPoolForContainer(CONTAINER_FLAGS);
+		
+		int startTime = System.GetTickCount();
+		for(int i = 0; i < m_Iterations; i++)
+			TW_LootManager.GetLootPoolForContainer(CONTAINER_FLAGS);
+		
+		Report("GetLootPoolForContainer", m_Iterations, System.GetTickCount() - startTime);
+	}
+	
+	protected void BenchmarkPoolDraw()
+	{
+		TW_LootPool pool = TW_LootManager.GetLootPoolForContainer(CONTAINER_FLAGS);
+		
+		int startTime = System.GetTickCount();
+		for(int i = 0; i < m_Iterations; i++)
+			pool.GetRandomItem();
+		
+		Report("TW_LootPool.GetRandomItem", m_Iterations, System.GetTickCount() - startTime);
+	}
+	
+	protected void BenchmarkSelectFromFlags(notnull TW_LootManager manager)
+	{
+		ref map<string, int> selected = new map<string, int>();
+		
+		int startTime = System.GetTickCount();
+		for(int i = 0; i < m_Iterations; i++)
+		{
+			selected.Clear();
+			manager.SelectRandomPrefabsFromFlags(CONTAINER_FLAGS, SELECT_COUNT, selected, TW_ResourceNameType.ResourceName);
+		}
+		
+		Report("SelectRandomPrefabsFromFlags", m_Iterations, System.GetTickCount() - startTime);
+	}
+	
+	protected void BenchmarkFlagHasResource()
+	{
+		int itemCount = m_Items.Count();
+		
+		int startTime = System.GetTickCount();
+		for(int i = 0; i < m_Iterations; i++)
+			TW_LootManager.FlagHasResource(CONTAINER_FLAGS, m_Items.Get(i % itemCount).resourceName);
+		
+		Report("FlagHasResource", m_Iterations, System.GetTickCount() - startTime);
+	}
+	
+	//! The respawn processor's due-container loop over a synthetic container set: queue pops, the outcome decision and re-pushes.
+	//! Respawned containers are searched again right away so the set keeps its size. Resetting a real container is not included
+	protected void BenchmarkRespawnProcessing()
+	{
+		ref array<float> respawnAfter = {};
+		ref array<int> cellIds = {};
+		ref set<int> blockedCells = new set<int>();
+		ref TW_LootDeadlineHeap queue = new TW_LootDeadlineHeap();
+		
+		for(int cellId = 0; cellId < RESPAWN_CELL_COUNT; cellId += BLOCKED_CELL_STRIDE)
+			blockedCells.Insert(cellId);
+		
+		for(int i = 0; i < m_ItemCount; i++)
+		{
+			float deadline = Math.RandomFloat(0, RESPAWN_SECONDS);
+			cellIds.Insert(Math.RandomInt(0, RESPAWN_CELL_COUNT));
+			
+			// Every fourth container was searched again after it was queued
+			if(i % 4 == 0)
+				respawnAfter.Insert(deadline + RESPAWN_CHECK_SECONDS * 2);
+			else
+				respawnAfter.Insert(deadline);
+			
+			queue.PushKey(i, deadline);
+		}
+		
+		float now = 0;
+		int processed = 0;
+		
+		int startTime = System.GetTickCount();
+		while(processed < m_Iterations)
+		{
+			now += RESPAWN_CHECK_SECONDS;
+			
+			while(processed < m_Iterations && queue.PeekDeadline() <= now)
+			{
+				int index = queue.PopKey();
+				processed++;
+				
+				float retryDeadline;
+				TW_LootRespawnOutcome outcome = TW_LootManager.GetRespawnOutcome(true, respawnAfter.Get(index), cellIds.Get(index), blockedCells, now, RESPAWN_CHECK_SECONDS, retryDeadline);
+				
+				if(outcome == TW_LootRespawnOutcome.Respawn)
+				{
+					retryDeadline = now + RESPAWN_SECONDS;
+					respawnAfter.Set(index, retryDeadline);
+				}
+				
+				queue.PushKey(index, retryDeadline);
+			}
+		}
+		
+		Report(string.Format("respawn processing (%1 containers)", m_ItemCount), m_Iterations, System.GetTickCount() - startTime);
+	}
+	
+	protected void BenchmarkWeightedPrefabs()
+	{
+		ref WeightedPrefabs prefabs = new WeightedPrefabs();
+		
+		foreach(TW_LootConfigItem item : m_Items)
+			prefabs.AddConfigItem(item);
+		
+		prefabs.GetRandomPrefab();
+		
+		int startTime = System.GetTickCount();
+		for(int i = 0; i < m_Iterations; i++)
+			prefabs.GetRandomPrefab();
+		
+		Report("WeightedPrefabs.GetRandomPrefab", m_Iterations, System.GetTickCount() - startTime);
+	}
+};
@@ -0,0 +1,56 @@
+/*
+	Min-heap of lootable containers ordered by a deadline in elapsed game seconds.
+	
+	Each entry is keyed by the container's loot cycle at the time it was pushed.
+	If the container is deleted or reset before the entry reaches the top,
+	the entry no longer matches and Pop discards it.
+*/
+class TW_LootContainerQueue : TW_LootDeadlineHeap
+{
+	protected ref array<TW_LootableInventoryComponent> m_Containers = {};
+	
+	override void Clear()
+	{
+		super.Clear();
+		m_Containers.Clear();
+	}
+	
+	void Push(notnull TW_LootableInventoryComponent container, float deadline)
+	{
+		m_Containers.Insert(container);
+		PushKey(container.GetLootCycle(), deadline);
+	}
+	
+	//! Remove the earliest entry. Returns null if its container was deleted or reset since it was pushed
+	TW_LootableInventoryComponent Pop()
+	{
+		if(m_Deadlines.IsEmpty())
+			return null;
+		
+		TW_LootableInventoryComponent container = m_Containers.Get(0);
+		int cycle = PopKey();
+		
+		if(!container || container.GetLootCycle() != cycle)
+			return null;
+		
+		return container;
+	}
+	
+	override protected void RemoveLast(int last)
+	{
+		super.RemoveLast(last);
+		m_Containers.Remove(last);
+	}
+	
+	override protected void Swap(int a, int b)
+	{
+		if(a == b)
+			return;
+		
+		super.Swap(a, b);
+		
+		TW_LootableInventoryComponent container = m_Containers.Get(a);
+		m_Containers.Set(a, m_Containers.Get(b));
+		m_Containers.Set(b, container);
+	}
+};
@@ -0,0 +1,113 @@
+/*
+	Min-heap of integer keys ordered by a deadline.
+	
+	Subclasses that carry more data per entry keep it in their own parallel arrays
+	and move it along in Swap and RemoveLast. TW_LootContainerQueue keys its entries
+	by loot cycle, the loot benchmark by index into a synthetic container set.
+*/
+class TW_LootDeadlineHeap
+{
+	protected ref array<float> m_Deadlines = {};
+	protected ref array<int> m_Keys = {};
+	
+	int Count() { return m_Deadlines.Count(); }
+	bool IsEmpty() { return m_Deadlines.IsEmpty(); }
+	
+	void Clear()
+	{
+		m_Deadlines.Clear();
+		m_Keys.Clear();
+	}
+	
+	void PushKey(int key, float deadline)
+	{
+		m_Deadlines.Insert(deadline);
+		m_Keys.Insert(key);
+		SiftUp(m_Deadlines.Count() - 1);
+	}
+	
+	//! Earliest deadline in the heap, float.MAX when empty
+	float PeekDeadline()
+	{
+		if(m_Deadlines.IsEmpty())
+			return float.MAX;
+		
+		return m_Deadlines.Get(0);
+	}
+	
+	//! Remove the earliest entry and return its key. The heap must not be empty
+	int PopKey()
+	{
+		int key = m_Keys.Get(0);
+		RemoveTop();
+		return key;
+	}
+	
+	protected void RemoveTop()
+	{
+		int last = m_Deadlines.Count() - 1;
+		Swap(0, last);
+		RemoveLast(last);
+		
+		if(last > 0)
+			SiftDown(0);
+	}
+	
+	protected void RemoveLast(int last)
+	{
+		m_Deadlines.Remove(last);
+		m_Keys.Remove(last);
+	}
+	
+	protected void SiftUp(int index)
+	{
+		while(index > 0)
+		{
+			int parent = (index - 1) / 2;
+			
+			if(m_Deadlines.Get(parent) <= m_Deadlines.Get(index))
+				return;
+			
+			Swap(parent, index);
+			index = parent;
+		}
+	}
+	
+	protected void SiftDown(int index)
+	{
+		int count = m_Deadlines.Count();
+		
+		while(true)
+		{
+			int smallest = index;
+			int left = index * 2 + 1;
+			int right = left + 1;
+			
+			if(left < count && m_Deadlines.Get(left) < m_Deadlines.Get(smallest))
+				smallest = left;
+			
+			if(right < count && m_Deadlines.Get(right) < m_Deadlines.Get(smallest))
+				smallest = right;
+			
+			if(smallest == index)
+				return;
+			
+			Swap(smallest, index);
+			index = smallest;
+		}
+	}
+	
+	protected void Swap(int a, int b)
+	{
+		if(a == b)
+			return;
+		
+		float deadline = m_Deadlines.Get(a);
+		m_Deadlines.Set(a, m_Deadlines.Get(b));
+		m_Deadlines.Set(b, deadline);
+		
+		int key = m_Keys.Get(a);
+		m_Keys.Set(a, m_Keys.Get(b));
+		m_Keys.Set(b, key);
+	}
+};
@@ -0,0 +1,81 @@
+/*
+	Per-frame work budget shared by the loot spawn and respawn paths.
+	
+	Work is measured in units (a container reset, an item spawned). A frame may
+	process up to the current batch size, and stops early once the script time
+	spent in the frame reaches the budget. The batch size adapts to the measured
+	server frame time: it halves while frames run over target and grows by one
+	while they are under it.
+*/
+class TW_LootFrameBudget
+{
+	protected float m_BudgetMs = 2;
+	protected float m_TargetFrameTimeMs = 33;
+	protected int m_MinBatchSize = 1;
+	protected int m_MaxBatchSize = 50;
+	protected int m_BatchSize = 10;
+	
+	protected float m_FrameStamp = -1;
+	protected int m_SliceStartTick;
+	protected int m_FrameUsedMs;
+	protected int m_FrameProcessed;
+	
+	void Configure(float budgetMs, float targetFrameTimeMs, int minBatchSize, int maxBatchSize)
+	{
+		m_BudgetMs = budgetMs;
+		m_TargetFrameTimeMs = targetFrameTimeMs;
+		m_MinBatchSize = Math.Max(1, minBatchSize);
+		m_MaxBatchSize = Math.Max(m_MinBatchSize, maxBatchSize);
+		m_BatchSize = Math.ClampInt(m_BatchSize, m_MinBatchSize, m_MaxBatchSize);
+	}
+	
+	float GetBudgetMs() { return m_BudgetMs; }
+	int GetBatchSize() { return m_BatchSize; }
+	
+	//! Milliseconds of script time used in the current frame so far
+	int GetUsedMs() { return m_FrameUsedMs; }
+	
+	//! Start a slice of work. The first slice of a new frame adapts the batch size
+	void Begin()
+	{
+		float worldTime = GetGame().GetWorld().GetWorldTime();
+		
+		if(worldTime != m_FrameStamp)
+		{
+			m_FrameStamp = worldTime;
+			m_FrameUsedMs = 0;
+			m_FrameProcessed = 0;
+			Adapt(GetGame().GetWorld().GetTimeSlice() * 1000);
+		}
+		
+		m_SliceStartTick = System.GetTickCount();
+	}
+	
+	//! Can one more unit of work run this frame
+	bool HasBudget()
+	{
+		if(m_FrameProcessed >= m_BatchSize)
+			return false;
+		
+		return m_FrameUsedMs + (System.GetTickCount() - m_SliceStartTick) < m_BudgetMs;
+	}
+	
+	void Consume(int units = 1)
+	{
+		m_FrameProcessed += units;
+	}
+	
+	//! Finish the slice started with Begin
+	void End()
+	{
+		m_FrameUsedMs += System.GetTickCount() - m_SliceStartTick;
+	}
+	
+	protected void Adapt(float frameTimeMs)
+	{
+		if(frameTimeMs > m_TargetFrameTimeMs)
+			m_BatchSize = Math.Max(m_MinBatchSize, m_BatchSize / 2);
+		else if(m_BatchSize < m_MaxBatchSize)
+			m_BatchSize++;
+	}
+};
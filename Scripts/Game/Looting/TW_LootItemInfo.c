@@ -0,0 +1,204 @@
+/*
+	Index record for a known loot item.
+	
+	Holds the interned item ID, the arsenal types the item is listed under and its
+	config entry, plus prefab capabilities resolved once when the loot table is indexed
+	so that queries such as "is this a weapon" never have to load the prefab again.
+*/
+class TW_LootItemInfo
+{
+	protected int m_Id;
+	protected ResourceName m_ResourceName;
+	protected SCR_EArsenalItemType m_TypeMask;
+	protected ref TW_LootConfigItem m_Config;
+	
+	protected bool m_IsResolved;
+	protected bool m_HasWeapon;
+	protected bool m_HasMagazine;
+	protected EStoragePurpose m_StoragePurpose = EStoragePurpose.PURPOSE_DEPOSIT;
+	protected ESlotSize m_SlotSize;
+	
+	// Magazine a weapon's muzzle is configured to spawn with
+	protected ResourceName m_DefaultMagazine;
+	
+	// Memoized answers for any other component names passed to HasComponent
+	protected ref map<string, bool> m_ComponentLookup;
+	
+	// Sorted prefabs of the children a freshly spawned entity comes with, such as a weapon's attachments and magazine
+	protected string m_SpawnedChildren;
+	protected bool m_HasSpawnedChildren;
+	
+	void TW_LootItemInfo(int id, TW_LootConfigItem config)
+	{
+		m_Id = id;
+		m_Config = config;
+		m_ResourceName = config.resourceName;
+	}
+	
+	int GetId() { return m_Id; }
+	ResourceName GetResourceName() { return m_ResourceName; }
+	TW_LootConfigItem GetConfig() { return m_Config; }
+	bool IsEnabled() { return m_Config.isEnabled; }
+	
+	//! Arsenal types whose loot table bucket lists this item
+	SCR_EArsenalItemType GetTypeMask() { return m_TypeMask; }
+	void SetTypeMask(SCR_EArsenalItemType mask) { m_TypeMask = mask; }
+	void AddType(SCR_EArsenalItemType type) { m_TypeMask = m_TypeMask | type; }
+	
+	bool IsResolved() { return m_IsResolved; }
+	bool HasWeapon() { EnsureResolved(); return m_HasWeapon; }
+	bool HasMagazine() { EnsureResolved(); return m_HasMagazine; }
+	EStoragePurpose GetStoragePurpose() { EnsureResolved(); return m_StoragePurpose; }
+	ESlotSize GetSlotSize() { EnsureResolved(); return m_SlotSize; }
+	ResourceName GetDefaultMagazine() { EnsureResolved(); return m_DefaultMagazine; }
+	
+	//! Magazines, medical items and clothing carry no state worth keeping, so they can be parked and reused
+	bool IsRecyclable()
+	{
+		EnsureResolved();
+		
+		if(m_HasWeapon)
+			return false;
+		
+		return m_HasMagazine || m_StoragePurpose == EStoragePurpose.PURPOSE_LOADOUT_PROXY || (m_TypeMask & SCR_EArsenalItemType.HEAL) != 0;
+	}
+	
+	protected void EnsureResolved()
+	{
+		if(!m_IsResolved)
+			Resolve(TW_LootManager.GetPrefabResource(m_ResourceName));
+	}
+	
+	//! Read capabilities from the prefab's component sources
+	void Resolve(Resource resource)
+	{
+		m_IsResolved = true;
+		
+		if(!resource)
+			return;
+		
+		IEntityComponentSource weaponSource = SCR_BaseContainerTools.FindComponentSource(resource, "WeaponComponent");
+		m_HasWeapon = weaponSource != null;
+		m_HasMagazine = SCR_BaseContainerTools.FindComponentSource(resource, "MagazineComponent") != null;
+		
+		if(m_HasWeapon)
+		{
+			m_StoragePurpose = EStoragePurpose.PURPOSE_WEAPON_PROXY;
+			m_DefaultMagazine = FindDefaultMagazine(weaponSource);
+		}
+		else if(SCR_BaseContainerTools.FindComponentSource(resource, "BaseLoadoutClothComponent"))
+			m_StoragePurpose = EStoragePurpose.PURPOSE_LOADOUT_PROXY;
+		
+		IEntityComponentSource itemSource = SCR_BaseContainerTools.FindComponentSource(resource, "InventoryItemComponent");
+		
+		if(!itemSource)
+			return;
+		
+		BaseContainer attributes = itemSource.GetObject("Attributes");
+		
+		if(attributes)
+			attributes.Get("m_Size", m_SlotSize);
+	}
+	
+	//! Remember what a freshly spawned entity of this prefab holds. Only the first one is recorded
+	void RecordSpawnedChildren(notnull IEntity entity)
+	{
+		if(m_HasSpawnedChildren)
+			return;
+		
+		m_SpawnedChildren = GetChildPrefabs(entity);
+		m_HasSpawnedChildren = true;
+	}
+	
+	//! True if entity holds exactly what a freshly spawned one did. False while no fresh one has been seen
+	bool HasSpawnedChildren(notnull IEntity entity)
+	{
+		return m_HasSpawnedChildren && GetChildPrefabs(entity) == m_SpawnedChildren;
+	}
+	
+	protected static string GetChildPrefabs(notnull IEntity entity)
+	{
+		ref array<string> prefabs = {};
+		
+		for(IEntity child = entity.GetChildren(); child; child = child.GetSibling())
+		{
+			EntityPrefabData prefabData = child.GetPrefabData();
+			
+			if(prefabData)
+				prefabs.Insert(prefabData.GetPrefabName());
+			else
+				prefabs.Insert(string.Empty);
+		}
+		
+		prefabs.Sort();
+		
+		string childPrefabs;
+		foreach(string prefab : prefabs)
+			childPrefabs += prefab + ";";
+		
+		return childPrefabs;
+	}
+	
+	//! Take capabilities resolved on an earlier run instead of loading the prefab, see TW_LootTableCache
+	void SetResolved(bool hasWeapon, bool hasMagazine, EStoragePurpose storagePurpose, ESlotSize slotSize, ResourceName defaultMagazine)
+	{
+		m_IsResolved = true;
+		m_HasWeapon = hasWeapon;
+		m_HasMagazine = hasMagazine;
+		m_StoragePurpose = storagePurpose;
+		m_SlotSize = slotSize;
+		m_DefaultMagazine = defaultMagazine;
+	}
+	
+	//! Magazine template of the first muzzle under the weapon component
+	protected static ResourceName FindDefaultMagazine(IEntityComponentSource weaponSource)
+	{
+		BaseContainerList components = weaponSource.GetObjectArray("components");
+		
+		if(!components)
+			return ResourceName.Empty;
+		
+		int count = components.Count();
+		for(int i = 0; i < count; i++)
+		{
+			BaseContainer component = components.Get(i);
+			typename componentType = component.GetClassName().ToType();
+			
+			if(!componentType || !componentType.IsInherited(BaseMuzzleComponent))
+				continue;
+			
+			ResourceName magazine;
+			if(component.Get("MagazineTemplate", magazine) && !magazine.IsEmpty())
+				return magazine;
+		}
+		
+		return ResourceName.Empty;
+	}
+	
+	//! Does the prefab have a component of this type? Weapon and magazine are answered from the index
+	bool HasComponent(string componentName)
+	{
+		EnsureResolved();
+		
+		if(componentName == "WeaponComponent")
+			return m_HasWeapon;
+		
+		if(componentName == "MagazineComponent")
+			return m_HasMagazine;
+		
+		if(!m_ComponentLookup)
+			m_ComponentLookup = new map<string, bool>();
+		
+		bool hasComponent;
+		if(m_ComponentLookup.Find(componentName, hasComponent))
+			return hasComponent;
+		
+		Resource resource = TW_LootManager.GetPrefabResource(m_ResourceName);
+		
+		if(resource)
+			hasComponent = SCR_BaseContainerTools.FindComponentSource(resource, componentName) != null;
+		
+		m_ComponentLookup.Set(componentName, hasComponent);
+		return hasComponent;
+	}
+};
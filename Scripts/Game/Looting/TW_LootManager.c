@@ -4,6 +4,18 @@ enum TW_ResourceNameType
 	DisplayName
 };
 
+//! What the respawn processor does with a container due in the respawn queue, see TW_LootManager.GetRespawnOutcome
+enum TW_LootRespawnOutcome
+{
+	// No longer searched, nothing to respawn
+	Drop,
+	// Searched again since it was queued, back in at its new deadline
+	Reschedule,
+	// A player is within DeadZoneRadius, tried again next check
+	Blocked,
+	Respawn
+};
+
 class TW_LootSettingsInterface : TW_SettingsInterface<LootManagerSettings>
 {
 	
@@ -31,17 +43,86 @@ sealed class TW_LootManager
 	// Provide the ability to grab 
 	private static ref map<SCR_EArsenalItemType, ref array<ref TW_LootConfigItem>> s_LootTable = new map<SCR_EArsenalItemType, ref array<ref TW_LootConfigItem>>();
 	
-	// This should contain the resource names of all items that are valid for saving/loading 
-	private static ref set<string> s_GlobalItems = new set<string>();
 	private static ref TW_GridCoordArrayManager<TW_LootableInventoryComponent> s_GlobalContainerGrid = new TW_GridCoordArrayManager<TW_LootableInventoryComponent>(100);
 	private static ref array<SCR_EArsenalItemType> s_ArsenalItemTypes = {};
+	
+	// Arsenal modes each prefab was registered with in the faction catalogs
+	private static ref map<ResourceName, SCR_EArsenalItemMode> s_ItemModes = new map<ResourceName, SCR_EArsenalItemMode>();
+	
+	// Precompiled loot pools keyed by container type mask, then mode mask
+	private static ref map<SCR_EArsenalItemType, ref map<SCR_EArsenalItemMode, ref TW_LootPool>> s_LootPoolCache = new map<SCR_EArsenalItemType, ref map<SCR_EArsenalItemMode, ref TW_LootPool>>();
+	
+	// Validated prefab handles shared by every spawn path
+	private static ref map<ResourceName, ref Resource> s_PrefabResources = new map<ResourceName, ref Resource>();
+	
+	// Every item that is valid for saving/loading, keyed by resource name and by interned ID
+	private static ref map<ResourceName, ref TW_LootItemInfo> s_ItemInfo = new map<ResourceName, ref TW_LootItemInfo>();
+	private static ref array<TW_LootItemInfo> s_ItemInfoById = {};
+	
+	// Translated display names, only valid for s_DisplayNameLanguage
+	private static ref map<ResourceName, string> s_DisplayNames = new map<ResourceName, string>();
+	private static string s_DisplayNameLanguage;
+	
+	// Grid text of every cell that holds a container, interned to an integer cell ID
+	private static ref map<string, int> s_GridCellIds = new map<string, int>();
+	
+	// Containers in each interned cell, used to prewarm the cells players move into
+	private static ref map<int, ref array<TW_LootableInventoryComponent>> s_CellContainers = new map<int, ref array<TW_LootableInventoryComponent>>();
+	
+	// Unsearched containers near players waiting to have their loot pre-rolled
+	private static ref array<TW_LootableInventoryComponent> s_PrewarmQueue = {};
+	private static bool s_IsPrewarmRunning;
+	
 	static TW_GridCoordArrayManager<TW_LootableInventoryComponent> GetContainerGrid() { return s_GlobalContainerGrid; }
 	
 	private static bool HasLoaded = false;
 	static const string LootFileName = "$profile:lootmap.json";	
 	
+	// Validated, merged loot table from the last cold start, see TW_LootTableCache
+	static const string LootCacheFileName = "$profile:lootmap.cache.json";
+	
+	// Searched containers and their respawn timers, see TW_LootStateSnapshot
+	static const string LootStateFileName = "$profile:lootstate.json";
+	
+	// Saved container state by position key, waiting for its container to register
+	private static ref map<string, int> s_RestoredLootState = new map<string, int>();
+	
+	// Game mode elapsed time the saved state was read at, restored timers count down from here
+	private static float s_LootStateLoadTime;
+	
+	// Admin commands, one per line. The file is deleted once its commands ran
+	static const string LootCommandFileName = "$profile:lootcommands.txt";
+	
+	// Loot table differs from lootmap.json and has to be written back
+	private static bool s_IsLootTableDirty;
+	
+	// lootmap.json sections whose type name this build does not know, e.g. from a newer mod version. Written back unchanged
+	private static ref map<string, ref array<ref TW_LootConfigItem>> s_UnknownLootSections = new map<string, ref array<ref TW_LootConfigItem>>();
+	
+	// lootmap.json and the cache are written once the game has started, see FlushLootTableFiles
+	private static bool s_HasPendingLootTableWrite;
+	private static const int LOOT_TABLE_WRITE_DELAY_MS = 5000;
+	
 	private ref LootManagerSettings m_Settings;
 	private SCR_BaseGameMode m_GameMode;
+	
+	// Shared per-frame budget for spawning and respawning loot
+	private static ref TW_LootFrameBudget s_FrameBudget = new TW_LootFrameBudget();
+	static TW_LootFrameBudget GetFrameBudget() { return s_FrameBudget; }
+	
+	// Every container's pending loot, served nearest-opener first
+	private static ref TW_LootSpawnQueue s_SpawnQueue = new TW_LootSpawnQueue();
+	private static bool s_IsSpawnQueueRunning;
+	static int GetSpawnQueueDepth() { return s_SpawnQueue.Count(); }
+	
+	// Counters and timings for the metrics command and dump
+	private static ref TW_LootMetrics s_Metrics = new TW_LootMetrics();
+	static TW_LootMetrics GetMetrics() { return s_Metrics; }
+	static const string LootMetricsFileName = "$profile:lootmetrics.csv";
+	
+	// Parked loot entities waiting to be reused
+	private static ref TW_LootRecyclePool s_RecyclePool = new TW_LootRecyclePool();
+	static int GetRecycledItemCount() { return s_RecyclePool.Count(); }
 		
 	LootManagerSettings GetLootSettings() { return m_Settings; }
 	bool ShouldSpawnMagazine() { return m_Settings.ShouldSpawnMagazine; }
@@ -85,88 +166,444 @@ sealed class TW_LootManager
 	int GetRespawnLootItemThreshold() { return m_Settings.RespawnSettings.NumberOfItemsToSpawnPerContainer; }
 	
 	int GetRespawnCheckInterval() { return m_Settings.RespawnSettings.RespawnLootTimerInSeconds; }
+	
+	int GetTrickleSpawnDelay() { return m_Settings.RespawnSettings.TrickleSpawnDelayMs; }
 
 	static void RegisterLootableContainer(TW_LootableInventoryComponent container)
 	{
 		if(s_GlobalContainerGrid)
 			s_GlobalContainerGrid.InsertByWorld(container.GetOwner().GetOrigin(), container);
+		
+		// Containers placed before the settings are loaded get their cell in InitializeLootTable
+		if(s_Instance && s_Instance.m_Settings)
+			AssignContainerCell(container);
+		
+		RestoreContainerState(container);
+	}
+	
+	//! Apply saved interaction state to a container, if the last snapshot had any for its position
+	private static void RestoreContainerState(notnull TW_LootableInventoryComponent container)
+	{
+		if(s_RestoredLootState.IsEmpty())
+			return;
+		
+		string key = TW_LootStateSnapshot.GetPositionKey(container.GetOwner().GetOrigin());
+		int remainingSeconds;
+		
+		if(!s_RestoredLootState.Find(key, remainingSeconds))
+			return;
+		
+		s_RestoredLootState.Remove(key);
+		
+		// Registered late -- the timer kept running since the state was read
+		remainingSeconds -= GetLootStateAge();
+		if(remainingSeconds > 0)
+			container.RestoreInteractionState(remainingSeconds);
+	}
+	
+	//! Seconds since the saved container state was read
+	private static int GetLootStateAge()
+	{
+		return TW_LootableInventoryComponent.GetGameMode().GetElapsedTime() - s_LootStateLoadTime;
+	}
+	
+	//! Read the last container snapshot and apply it to containers that already registered. The rest are restored as they register
+	private static void LoadLootState()
+	{
+		if(!FileIO.FileExists(LootStateFileName))
+			return;
+		
+		TW_LootStateSnapshot snapshot = new TW_LootStateSnapshot();
+		SCR_JsonLoadContext context = TW_Util.LoadJsonFile(LootStateFileName, true);
+		
+		if(!context || !context.ReadValue("", snapshot) || snapshot.Version != TW_LootStateSnapshot.FORMAT_VERSION)
+		{
+			PrintFormat("TrainWreck: Ignoring unreadable or outdated %1", LootStateFileName, LogLevel.WARNING);
+			return;
+		}
+		
+		s_LootStateLoadTime = TW_LootableInventoryComponent.GetGameMode().GetElapsedTime();
+		
+		int count = snapshot.Count();
+		for(int i = 0; i < count; i++)
+			s_RestoredLootState.Set(snapshot.Positions.Get(i), snapshot.RemainingSeconds.Get(i));
+		
+		ref array<TW_LootableInventoryComponent> containers = {};
+		s_GlobalContainerGrid.GetAllItems(containers);
+		
+		foreach(TW_LootableInventoryComponent container : containers)
+		{
+			if(container)
+				RestoreContainerState(container);
+		}
+		
+		PrintFormat("TrainWreck: Restored %1 searched containers from %2", count - s_RestoredLootState.Count(), LootStateFileName);
+	}
+	
+	//! Save every searched container with the seconds left until its loot respawns
+	private static void SaveLootState()
+	{
+		int startTime = System.GetTickCount();
+		float elapsed = TW_LootableInventoryComponent.GetGameMode().GetElapsedTime();
+		
+		TW_LootStateSnapshot snapshot = new TW_LootStateSnapshot();
+		snapshot.Version = TW_LootStateSnapshot.FORMAT_VERSION;
+		
+		ref array<TW_LootableInventoryComponent> containers = {};
+		s_GlobalContainerGrid.GetAllItems(containers);
+		
+		foreach(TW_LootableInventoryComponent container : containers)
+		{
+			if(!container || !container.HasBeenInteractedWith())
+				continue;
+			
+			snapshot.Add(container.GetOwner().GetOrigin(), Math.Max(0, container.GetRespawnLootAfterTime() - elapsed));
+		}
+		
+		// Containers that have not registered yet keep their saved state until their timer runs out
+		int age = GetLootStateAge();
+		ref array<string> expired = {};
+		foreach(string position, int remainingSeconds : s_RestoredLootState)
+		{
+			if(remainingSeconds <= age)
+			{
+				expired.Insert(position);
+				continue;
+			}
+			
+			snapshot.Positions.Insert(position);
+			snapshot.RemainingSeconds.Insert(remainingSeconds - age);
+		}
+		
+		foreach(string position : expired)
+			s_RestoredLootState.Remove(position);
+		
+		if(!TW_Util.SaveJsonFile(LootStateFileName, snapshot, false))
+		{
+			PrintFormat("TrainWreck: Failed to write %1", LootStateFileName, LogLevel.WARNING);
+			return;
+		}
+		
+		if(TW_LootManager.GetInstance().IsDebug())
+			PrintFormat("TrainWreck: Saved %1 searched containers in %2ms", snapshot.Count(), System.GetTickCount() - startTime);
+	}
+	
+	//! Integer ID for a grid cell's text, interning it on first use
+	static int GetGridCellId(string gridText)
+	{
+		int cellId;
+		
+		if(s_GridCellIds.Find(gridText, cellId))
+			return cellId;
+		
+		cellId = s_GridCellIds.Count();
+		s_GridCellIds.Insert(gridText, cellId);
+		return cellId;
+	}
+	
+	//! Grid cell of a container, resolved the first time it is asked for
+	static int GetContainerCellId(notnull TW_LootableInventoryComponent container)
+	{
+		if(container.GetGridCellId() < 0)
+			AssignContainerCell(container);
+		
+		return container.GetGridCellId();
+	}
+	
+	private static void AssignContainerCell(notnull TW_LootableInventoryComponent container)
+	{
+		string gridText = TW_Util.ToGridText(container.GetOwner().GetOrigin(), s_Instance.m_Settings.RespawnSettings.GridSize);
+		int cellId = GetGridCellId(gridText);
+		
+		if(container.GetGridCellId() == cellId)
+			return;
+		
+		RemoveFromCell(container);
+		container.SetGridCellId(cellId);
+		
+		ref array<TW_LootableInventoryComponent> cellContainers = s_CellContainers.Get(cellId);
+		
+		if(!cellContainers)
+		{
+			cellContainers = {};
+			s_CellContainers.Insert(cellId, cellContainers);
+		}
+		
+		cellContainers.Insert(container);
+	}
+	
+	private static void RemoveFromCell(notnull TW_LootableInventoryComponent container)
+	{
+		if(container.GetGridCellId() < 0)
+			return;
+		
+		array<TW_LootableInventoryComponent> cellContainers = s_CellContainers.Get(container.GetGridCellId());
+		
+		if(cellContainers)
+			cellContainers.RemoveItem(container);
+	}
+	
+	//! Convert the monitor's grid text to cell IDs. Cells without containers were never interned and cannot match anything
+	private static void ToCellIds(set<string> chunks, notnull set<int> cellIds)
+	{
+		cellIds.Clear();
+		
+		foreach(string chunk : chunks)
+		{
+			int cellId;
+			
+			if(s_GridCellIds.Find(chunk, cellId))
+				cellIds.Insert(cellId);
+		}
 	}
 	
 	static void UnregisterLootableContainer(TW_LootableInventoryComponent container)
 	{
 		if(s_GlobalContainerGrid)
 			s_GlobalContainerGrid.RemoveByWorld(container.GetOwner().GetOrigin(), container);
+		
+		RemoveFromCell(container);
 	}
 		
-	//! Is this resource in the global items set? - IF not --> invalid.
-	static bool IsValidItem(ResourceName resource)
+	//! Cached prefab handle for a loot item. Loaded once on first use, null if the prefab is invalid
+	static Resource GetPrefabResource(ResourceName resourceName)
+	{
+		Resource resource = s_PrefabResources.Get(resourceName);
+		
+		if(resource)
+			return resource;
+		
+		if(resourceName.IsEmpty())
+			return null;
+		
+		resource = Resource.Load(resourceName);
+		
+		if(!resource || !resource.IsValid())
+			return null;
+		
+		s_PrefabResources.Set(resourceName, resource);
+		return resource;
+	}
+	
+	//! Index record for a known item, null when the resource was never registered
+	static TW_LootItemInfo GetItemInfo(ResourceName resourceName)
 	{
-		return s_GlobalItems.Contains(resource);
+		return s_ItemInfo.Get(resourceName);
 	}
 	
-	static bool FlagHasResource(SCR_EArsenalItemType flags, ResourceName resource)
+	static TW_LootItemInfo GetItemInfoById(int id)
 	{
-		if(resource.IsEmpty())
+		if(id < 0 || id >= s_ItemInfoById.Count())
+			return null;
+		
+		return s_ItemInfoById.Get(id);
+	}
+	
+	//! Interned ID of a known item, -1 when unknown
+	static int GetItemId(ResourceName resourceName)
+	{
+		TW_LootItemInfo info = s_ItemInfo.Get(resourceName);
+		
+		if(!info)
+			return -1;
+		
+		return info.GetId();
+	}
+	
+	//! Magazine a weapon prefab spawns with, read from prefab data when the loot table was indexed
+	static ResourceName GetDefaultMagazine(ResourceName weaponPrefab)
+	{
+		TW_LootItemInfo info = s_ItemInfo.Get(weaponPrefab);
+		
+		if(!info)
+			return ResourceName.Empty;
+		
+		return info.GetDefaultMagazine();
+	}
+	
+	//! Add a config entry to the item index. Returns false if the resource was already registered
+	private static bool RegisterItem(notnull TW_LootConfigItem config)
+	{
+		if(s_ItemInfo.Contains(config.resourceName))
 			return false;
 		
-		foreach(SCR_EArsenalItemType itemType : s_ArsenalItemTypes)
+		ref TW_LootItemInfo info = new TW_LootItemInfo(s_ItemInfoById.Count(), config);
+		s_ItemInfo.Set(config.resourceName, info);
+		s_ItemInfoById.Insert(info);
+		return true;
+	}
+	
+	//! Recompute type masks from the final loot table and resolve prefab metadata of every entry
+	private static void IndexLootPrefabs()
+	{
+		int startTime = System.GetTickCount();
+		
+		foreach(ResourceName resourceName, TW_LootItemInfo info : s_ItemInfo)
+			info.SetTypeMask(0);
+		
+		foreach(SCR_EArsenalItemType type, ref array<ref TW_LootConfigItem> items : s_LootTable)
 		{
-			if(!s_LootTable.Contains(itemType))
-				continue;
-			
-			if(!SCR_Enum.HasFlag(flags, itemType))
-				continue;
-			
-			ref array<ref TW_LootConfigItem> items = s_LootTable.Get(itemType);
-			foreach(ref TW_LootConfigItem item : items)
+			foreach(TW_LootConfigItem item : items)
 			{
-				if(item.resourceName == resource)
-					return true;
+				RegisterItem(item);
+				
+				TW_LootItemInfo itemInfo = s_ItemInfo.Get(item.resourceName);
+				itemInfo.AddType(type);
+				
+				if(!itemInfo.IsResolved())
+					itemInfo.Resolve(GetPrefabResource(item.resourceName));
 			}
 		}
 		
-		return false;
+		int magazineMappings = 0;
+		foreach(ResourceName indexedName, TW_LootItemInfo indexedInfo : s_ItemInfo)
+		{
+			if(indexedInfo.IsResolved() && !indexedInfo.GetDefaultMagazine().IsEmpty())
+				magazineMappings++;
+		}
+		
+		PrintFormat("TrainWreck: Indexed %1 loot prefabs (%2 weapon magazines) in %3ms", s_ItemInfo.Count(), magazineMappings, System.GetTickCount() - startTime);
+	}
+	
+	//! Parked entity of this prefab ready for reuse, null when none is available
+	static IEntity TakeRecycledItem(ResourceName resourceName)
+	{
+		if(!s_RecyclePool.IsEnabled())
+			return null;
+		
+		return s_RecyclePool.Take(resourceName);
+	}
+	
+	//! Park a loot entity that is outside any storage for reuse. Returns false if it cannot be recycled and should be deleted
+	static bool RecycleItem(IEntity item)
+	{
+		if(!item || !s_RecyclePool.IsEnabled())
+			return false;
+		
+		// Anything holding other entities, such as a vest with items inside, is not reused
+		if(item.GetChildren())
+			return false;
+		
+		EntityPrefabData prefabData = item.GetPrefabData();
+		
+		if(!prefabData)
+			return false;
+		
+		ResourceName prefab = prefabData.GetPrefabName();
+		TW_LootItemInfo info = s_ItemInfo.Get(prefab);
+		
+		if(!info || !info.IsRecyclable() || IsDamaged(item))
+			return false;
+		
+		return s_RecyclePool.Park(item, prefab);
+	}
+	
+	//! Damage state is not kept when an item is parked or virtualized, so damaged items stay as they are
+	static bool IsDamaged(notnull IEntity item)
+	{
+		SCR_DamageManagerComponent damageManager = SCR_DamageManagerComponent.Cast(item.FindComponent(SCR_DamageManagerComponent));
+		return damageManager && damageManager.GetHealthScaled() < 1;
+	}
+	
+	//! Translated prefab display name. Cached per resource until the UI language changes
+	static string GetTranslatedDisplayName(ResourceName resourceName)
+	{
+		string language = WidgetManager.GetLanguage();
+		
+		if(language != s_DisplayNameLanguage)
+		{
+			s_DisplayNames.Clear();
+			s_DisplayNameLanguage = language;
+		}
+		
+		string displayName;
+		
+		if(s_DisplayNames.Find(resourceName, displayName))
+			return displayName;
+		
+		displayName = WidgetManager.Translate(TW_Util.GetPrefabDisplayName(resourceName));
+		s_DisplayNames.Set(resourceName, displayName);
+		return displayName;
+	}
+	
+	//! Is this resource in the global items set? - IF not --> invalid.
+	static bool IsValidItem(ResourceName resource)
+	{
+		return s_ItemInfo.Contains(resource);
+	}
+	
+	//! Is the resource listed in the loot table under any of the given arsenal types
+	static bool FlagHasResource(SCR_EArsenalItemType flags, ResourceName resource)
+	{
+		if(resource.IsEmpty())
+			return false;
+		
+		TW_LootItemInfo info = s_ItemInfo.Get(resource);
+		
+		if(!info)
+			return false;
+		
+		return (info.GetTypeMask() & flags) != 0;
 	}
 			
+	//! Select up to count distinct prefabs across the given arsenal types
 	void SelectRandomPrefabsFromFlags(SCR_EArsenalItemType flags, int count, notnull map<string, int> selected, TW_ResourceNameType type = TW_ResourceNameType.DisplayName)
 	{
-		int selectedCount = 0;
+		ref array<SCR_EArsenalItemType> itemTypes = {};
+		ref array<ref TW_UniqueIndexSampler> samplers = {};
+		int available = 0;
 		
 		foreach(SCR_EArsenalItemType itemType : s_ArsenalItemTypes)
 		{
-			if(selectedCount >= count)
-				return;
-			
 			if(!SCR_Enum.HasFlag(flags, itemType))
 				continue;
 			
-			if(!s_LootTable.Contains(itemType))
-				continue;
+			ref array<ref TW_LootConfigItem> entries = s_LootTable.Get(itemType);
 			
-			ref array<ResourceName> items = {};
-			selectedCount += SelectRandomPrefabsFromType(itemType, Math.RandomIntInclusive(1, count), items);
+			if(!entries || entries.IsEmpty())
+				continue;
 			
-			foreach(ResourceName name : items)
+			itemTypes.Insert(itemType);
+			samplers.Insert(new TW_UniqueIndexSampler(entries.Count()));
+			available += entries.Count();
+		}
+		
+		// The flags may cover fewer items than were asked for
+		int target = Math.Min(count, available);
+		int selectedCount = 0;
+		ref array<ResourceName> items = {};
+		
+		// Every pass draws at least one new item, so this ends within target passes
+		while(selectedCount < target)
+		{
+			int typeCount = itemTypes.Count();
+			for(int i = 0; i < typeCount && selectedCount < target; i++)
 			{
-				string value = name;
-				switch(type)
+				TW_UniqueIndexSampler sampler = samplers.Get(i);
+				
+				if(sampler.Remaining() <= 0)
+					continue;
+				
+				items.Clear();
+				selectedCount += SelectRandomPrefabsFromType(itemTypes.Get(i), Math.RandomIntInclusive(1, target - selectedCount), items, sampler);
+				
+				foreach(ResourceName name : items)
 				{
-					case TW_ResourceNameType.DisplayName:
-						value = WidgetManager.Translate(TW_Util.GetPrefabDisplayName(name));
-						break;
+					string value = name;
+					switch(type)
+					{
+						case TW_ResourceNameType.DisplayName:
+							value = GetTranslatedDisplayName(name);
+							break;
+					}
+					
+					if(selected.Contains(value))
+						selected.Set(value, selected.Get(value) + 1);
+					else
+						selected.Set(value, 1);
 				}
-				
-				if(selected.Contains(value))
-					selected.Set(value, selected.Get(value) + 1);
-				else
-					selected.Set(value, 1);
 			}
 		}
-		
-		// If we didn't select enough, we'll do it again.
-		// Subtracting what we have from the desired amount
-		if(selectedCount < count)
-			SelectRandomPrefabsFromFlags(flags, count - selectedCount, selected, type);
 	}
 	
 	void PrintSettings()
@@ -185,36 +622,37 @@ sealed class TW_LootManager
 		Print("------------------------");
 	}
 	
-	int SelectRandomPrefabsFromType(SCR_EArsenalItemType flag, int randomCount, notnull array<ResourceName> selected)
+	//! Select up to randomCount distinct prefabs of one arsenal type. Pass a sampler to continue drawing without repeats across calls
+	int SelectRandomPrefabsFromType(SCR_EArsenalItemType flag, int randomCount, notnull array<ResourceName> selected, TW_UniqueIndexSampler sampler = null)
 	{
 		if(!s_LootTable.Contains(flag))
 			return 0;
 		
 		ref array<ref TW_LootConfigItem> items = s_LootTable.Get(flag);
-		ref set<int> indicies = new set<int>();
+		
+		ref TW_UniqueIndexSampler ownSampler;
+		if(!sampler)
+		{
+			ownSampler = new TW_UniqueIndexSampler(items.Count());
+			sampler = ownSampler;
+		}
 		
 		int count = 0;
 		for(int i = 0; i < randomCount; i++)
 		{			
-			ref TW_LootConfigItem item = items.GetRandomElement();
-			
-			int randomIndex = items.GetRandomIndex();
+			int randomIndex = sampler.Next();
 			
-			while(indicies.Contains(randomIndex) && selected.Count() < items.Count())
-				randomIndex = items.GetRandomIndex();	
-			
-			if(indicies.Contains(randomIndex))
+			if(randomIndex < 0)
 				break;
 			
 			count++;
-			indicies.Insert(randomIndex);
 			selected.Insert(items.Get(randomIndex).resourceName);
 		}
 		
 		return count;
 	}
 	
-	array<SCR_EntityCatalogEntry> GetMergedFactionCatalogs()
+	static array<SCR_EntityCatalogEntry> GetMergedFactionCatalogs()
 	{		
 		SCR_FactionManager manager = SCR_FactionManager.Cast(GetGame().GetFactionManager());
 		
@@ -256,8 +694,20 @@ sealed class TW_LootManager
 	
 	void InitializeLootTable()
 	{
+		int startTime = System.GetTickCount();
 		SCR_Enum.GetEnumValues(SCR_EArsenalItemType, s_ArsenalItemTypes);
 		
+		// Same file, addons and build as last time -- skip validation and catalog merging
+		if(TryLoadLootTableCache(ComputeLootCacheKey()))
+		{
+			HasLoaded = true;
+			IndexLootPrefabs();
+			InvalidateLootPools();
+			WarmLootPools();
+			PrintFormat("TrainWreck: Loaded loot table from %1 in %2ms (warm start)", LootCacheFileName, System.GetTickCount() - startTime);
+			return;
+		}
+		
 		// If lootmap already exists -- load everything from file
 		// Then merge things that are in-game
 		if(HasLootTable())
@@ -265,7 +715,11 @@ sealed class TW_LootManager
 			Print(string.Format("TrainWreck: Detected loot table %1", LootFileName));
 			IngestLootTableFromFile(m_Settings);
 		}
-		else m_Settings = new LootManagerSettings();			
+		else
+		{
+			m_Settings = new LootManagerSettings();
+			s_IsLootTableDirty = true;
+		}
 		
 		ref array<SCR_EntityCatalogEntry> catalogItems = GetMergedFactionCatalogs();
 		int entityCount = catalogItems.Count();
@@ -290,13 +744,17 @@ sealed class TW_LootManager
 				auto itemMode = arsenalItem.GetItemMode();
 				ResourceName prefab = entry.GetPrefab();
 				
+				// Factions may register the same prefab under different modes
+				SCR_EArsenalItemMode knownModes;
+				if(s_ItemModes.Find(prefab, knownModes))
+					itemMode = itemMode | knownModes;
+				s_ItemModes.Set(prefab, itemMode);
+				
 				// If we already had a lootmap from file
 				// and the items is loaded -- ignore readding it
-				if(s_GlobalItems.Contains(prefab))
+				if(s_ItemInfo.Contains(prefab))
 					continue;
 				
-				s_GlobalItems.Insert(prefab);
-				
 				arsenalItem.SetItemPrefab(prefab);
 				
 				int defaultCount = 1;
@@ -317,6 +775,8 @@ sealed class TW_LootManager
 				ref TW_LootConfigItem config = new TW_LootConfigItem();
 				
 				config.SetData(prefab, defaultChance, defaultCount, null, arsenalItem.ShouldSpawn());
+				RegisterItem(config);
+				s_IsLootTableDirty = true;
 				
 				if(!s_LootTable.Contains(itemType))
 					s_LootTable.Insert(itemType, {});
@@ -325,9 +785,9 @@ sealed class TW_LootManager
 			}
 		}
 		
-		bool success = OutputLootTableFile();
-		if(!success)
-			Print(string.Format("TrainWreck: Failed to write %1", LootFileName), LogLevel.ERROR);
+		// Snapshot the table before disabled entries are dropped, the file keeps them
+		PrepareLootTableOutput();
+		s_HasPendingLootTableWrite = true;
 		
 		HasLoaded = true;
 		
@@ -348,54 +808,699 @@ sealed class TW_LootManager
 			}
 		}
 		
+		IndexLootPrefabs();
+		InvalidateLootPools();
+		WarmLootPools();
+		
+		PrintFormat("TrainWreck: Built loot table in %1ms (cold start)", System.GetTickCount() - startTime);
 	}
 	
-	
-	//! Initialize the entire loot system
-	void Initialize()
+	//! Write lootmap.json if merging changed it, then the cache keyed on the file as written
+	private void FlushLootTableFiles()
 	{
-		m_GameMode = SCR_BaseGameMode.Cast(GetGame().GetGameMode());
+		if(!s_HasPendingLootTableWrite)
+			return;
 		
-		if(!TW_MonitorPositions.GetInstance())
+		s_HasPendingLootTableWrite = false;
+		int startTime = System.GetTickCount();
+		
+		if(s_IsLootTableDirty)
 		{
-			Print("TrainWreck: Position monitor is null. Unable to initialize Loot Manager", LogLevel.ERROR);
-			return;
+			if(!OutputLootTableFile())
+				Print(string.Format("TrainWreck: Failed to write %1", LootFileName), LogLevel.ERROR);
+			
+			s_IsLootTableDirty = false;
 		}
+		else if(IsDebug())
+			PrintFormat("TrainWreck: %1 is up to date, skipping write", LootFileName);
 		
-		m_GameMode.GetOnInitializePlugins().Insert(AddListeners);
+		if(!SaveLootTableCache(ComputeLootCacheKey()))
+			PrintFormat("TrainWreck: Failed to write %1", LootCacheFileName, LogLevel.WARNING);
 		
-		m_GameMode.GetOnGameStarted().Insert(DelayInitialize);
+		PrintFormat("TrainWreck: Wrote loot table files in %1ms", System.GetTickCount() - startTime);
+	}
+	
+	//! Identifies the loot table inputs: lootmap.json contents, faction catalog contents, loaded addons, game build and world.
+	//! Empty when there is no loot file yet
+	private static string ComputeLootCacheKey()
+	{
+		FileHandle file = FileIO.OpenFile(LootFileName, FileMode.READ);
+		
+		if(!file)
+			return string.Empty;
+		
+		int fileHash = 0;
+		string line;
+		while(file.ReadLine(line) >= 0)
+			fileHash = fileHash * 31 + line.Hash();
+		file.Close();
+		
+		ref array<string> addons = {};
+		GameProject.GetLoadedAddons(addons);
+		
+		// Catalogs merged into the table come from the loaded world and mission
+		string key = string.Format("%1|%2|%3|%4|%5", fileHash, ComputeCatalogFingerprint(), GetGame().GetBuildVersion(), GetGame().GetWorldFile(), GetGame().GetMissionName());
+		foreach(string addon : addons)
+			key += "|" + addon;
+		
+		return key;
+	}
+	
+	//! Hash of the arsenal entries the cold start would merge in. An addon changing its catalogs without a new GUID still changes this.
+	//! Catalogs are configs the faction manager already holds, no prefab is loaded
+	private static int ComputeCatalogFingerprint()
+	{
+		array<SCR_EntityCatalogEntry> catalogItems = GetMergedFactionCatalogs();
+		
+		if(!catalogItems)
+			return 0;
+		
+		int fingerprint = catalogItems.Count();
+		ref array<SCR_BaseEntityCatalogData> itemData = {};
+		
+		foreach(SCR_EntityCatalogEntry entry : catalogItems)
+		{
+			fingerprint = fingerprint * 31 + entry.GetPrefab().Hash();
+			
+			itemData.Clear();
+			entry.GetEntityDataList(itemData);
+			
+			foreach(SCR_BaseEntityCatalogData data : itemData)
+			{
+				SCR_ArsenalItem arsenalItem = SCR_ArsenalItem.Cast(data);
+				
+				if(!arsenalItem)
+					continue;
+				
+				fingerprint = fingerprint * 31 + arsenalItem.GetItemType();
+				fingerprint = fingerprint * 31 + arsenalItem.GetItemMode();
+				
+				if(arsenalItem.IsEnabled())
+					fingerprint++;
+			}
+		}
+		
+		return fingerprint;
+	}
+	
+	//! Fill the loot table from the cache when its key matches
+	private bool TryLoadLootTableCache(string cacheKey)
+	{
+		if(cacheKey.IsEmpty() || !FileIO.FileExists(LootCacheFileName))
+			return false;
+		
+		TW_LootTableCache cache = new TW_LootTableCache();
+		SCR_JsonLoadContext context = TW_Util.LoadJsonFile(LootCacheFileName, true);
+		
+		if(!context || !context.ReadValue("", cache) || !cache.IsValid(cacheKey))
+		{
+			Print("TrainWreck: Loot table cache is missing or out of date, rebuilding");
+			return false;
+		}
+		
+		m_Settings = cache.Settings;
+		m_Settings.LootTable = new map<string, ref array<ref TW_LootConfigItem>>();
+		
+		int count = cache.Count();
+		for(int i = 0; i < count; i++)
+		{
+			TW_LootConfigItem config = cache.CreateConfig(i);
+			
+			if(!RegisterItem(config))
+				continue;
+			
+			cache.RestoreInfo(i, s_ItemInfo.Get(config.resourceName));
+			
+			SCR_EArsenalItemMode itemMode = cache.Modes.Get(i);
+			if(itemMode != 0)
+				s_ItemModes.Set(config.resourceName, itemMode);
+			
+			// Dropped entries stay in the index so IDs match a cold start
+			if(!cache.Listed.Get(i))
+				continue;
+			
+			SCR_EArsenalItemType itemType = cache.Types.Get(i);
+			if(!s_LootTable.Contains(itemType))
+				s_LootTable.Insert(itemType, {});
+			
+			s_LootTable.Get(itemType).Insert(config);
+		}
+		
+		return true;
+	}
+	
+	//! Snapshot the indexed loot table. The key must be computed after lootmap.json was written
+	private bool SaveLootTableCache(string cacheKey)
+	{
+		if(cacheKey.IsEmpty())
+			return false;
+		
+		TW_LootTableCache cache = new TW_LootTableCache();
+		cache.Version = TW_LootTableCache.FORMAT_VERSION;
+		cache.Key = cacheKey;
+		cache.Settings = m_Settings;
+		
+		ref map<ResourceName, SCR_EArsenalItemType> listedTypes = new map<ResourceName, SCR_EArsenalItemType>();
+		foreach(SCR_EArsenalItemType type, ref array<ref TW_LootConfigItem> items : s_LootTable)
+		{
+			foreach(TW_LootConfigItem item : items)
+				listedTypes.Set(item.resourceName, type);
+		}
+		
+		// Whole index in ID order, entries dropped from the table included
+		foreach(TW_LootItemInfo info : s_ItemInfoById)
+		{
+			TW_LootConfigItem config = info.GetConfig();
+			
+			SCR_EArsenalItemType itemType;
+			bool isListed = listedTypes.Find(config.resourceName, itemType);
+			
+			SCR_EArsenalItemMode itemMode;
+			s_ItemModes.Find(config.resourceName, itemMode);
+			cache.AddItem(itemType, itemMode, isListed, config, info);
+		}
+		
+		// The table is already in the cache's arrays, keep it out of the settings copy
+		map<string, ref array<ref TW_LootConfigItem>> lootTable = m_Settings.LootTable;
+		m_Settings.LootTable = null;
+		bool success = TW_Util.SaveJsonFile(LootCacheFileName, cache, false);
+		m_Settings.LootTable = lootTable;
+		
+		return success;
+	}
+	
+	// Live loot table set aside while a synthetic one is installed
+	private static ref map<SCR_EArsenalItemType, ref array<ref TW_LootConfigItem>> s_StashedLootTable;
+	private static ref map<ResourceName, ref TW_LootItemInfo> s_StashedItemInfo;
+	private static ref array<TW_LootItemInfo> s_StashedItemInfoById;
+	private static ref map<SCR_EArsenalItemType, ref map<SCR_EArsenalItemMode, ref TW_LootPool>> s_StashedLootPoolCache;
+	
+	//! Swap in a synthetic loot table until RestoreLootTable. The items are never loaded as prefabs,
+	//! every one is indexed as plain deposit loot of its type. Used by TW_LootBenchmark
+	static bool InstallSyntheticLootTable(notnull array<ref TW_LootConfigItem> items, notnull array<SCR_EArsenalItemType> types)
+	{
+		if(s_StashedLootTable || items.Count() != types.Count())
+			return false;
+		
+		if(s_ArsenalItemTypes.IsEmpty())
+			SCR_Enum.GetEnumValues(SCR_EArsenalItemType, s_ArsenalItemTypes);
+		
+		s_StashedLootTable = s_LootTable;
+		s_StashedItemInfo = s_ItemInfo;
+		s_StashedItemInfoById = s_ItemInfoById;
+		s_StashedLootPoolCache = s_LootPoolCache;
+		
+		s_LootTable = new map<SCR_EArsenalItemType, ref array<ref TW_LootConfigItem>>();
+		s_ItemInfo = new map<ResourceName, ref TW_LootItemInfo>();
+		s_ItemInfoById = {};
+		s_LootPoolCache = new map<SCR_EArsenalItemType, ref map<SCR_EArsenalItemMode, ref TW_LootPool>>();
+		
+		int count = items.Count();
+		for(int i = 0; i < count; i++)
+		{
+			TW_LootConfigItem item = items.Get(i);
+			SCR_EArsenalItemType itemType = types.Get(i);
+			
+			if(!RegisterItem(item))
+				continue;
+			
+			TW_LootItemInfo info = s_ItemInfo.Get(item.resourceName);
+			info.SetResolved(false, false, EStoragePurpose.PURPOSE_DEPOSIT, ESlotSize.SLOT_1x1, ResourceName.Empty);
+			info.AddType(itemType);
+			
+			if(!s_LootTable.Contains(itemType))
+				s_LootTable.Insert(itemType, {});
+			
+			s_LootTable.Get(itemType).Insert(item);
+		}
+		
+		return true;
+	}
+	
+	//! Put back the live loot table set aside by InstallSyntheticLootTable
+	static void RestoreLootTable()
+	{
+		if(!s_StashedLootTable)
+			return;
+		
+		s_LootTable = s_StashedLootTable;
+		s_ItemInfo = s_StashedItemInfo;
+		s_ItemInfoById = s_StashedItemInfoById;
+		s_LootPoolCache = s_StashedLootPoolCache;
+		
+		s_StashedLootTable = null;
+		s_StashedItemInfo = null;
+		s_StashedItemInfoById = null;
+		s_StashedLootPoolCache = null;
+	}
+	
+	//! Drop precompiled loot pools. Must be called whenever the loot table changes.
+	//! With a type mask only the pools drawing from those arsenal types are dropped
+	static void InvalidateLootPools(SCR_EArsenalItemType changedTypes = 0)
+	{
+		if(changedTypes == 0)
+		{
+			s_LootPoolCache.Clear();
+			return;
+		}
+		
+		ref array<SCR_EArsenalItemType> stale = {};
+		foreach(SCR_EArsenalItemType flags, ref map<SCR_EArsenalItemMode, ref TW_LootPool> modePools : s_LootPoolCache)
+		{
+			if((flags & changedTypes) != 0)
+				stale.Insert(flags);
+		}
+		
+		foreach(SCR_EArsenalItemType staleFlags : stale)
+			s_LootPoolCache.Remove(staleFlags);
+	}
+	
+	//! Precompile pools and resolve grid cells for every container that registered before the loot table was loaded
+	private static void WarmLootPools()
+	{
+		ref array<TW_LootableInventoryComponent> containers = {};
+		s_GlobalContainerGrid.GetAllItems(containers);
+		
+		foreach(TW_LootableInventoryComponent container : containers)
+		{
+			if(!container)
+				continue;
+			
+			GetLootPoolForContainer(container.GetTypeFlags(), container.GetModeFlags());
+			AssignContainerCell(container);
+		}
+		
+		int poolCount = 0;
+		foreach(SCR_EArsenalItemType flags, ref map<SCR_EArsenalItemMode, ref TW_LootPool> modePools : s_LootPoolCache)
+			poolCount += modePools.Count();
+		
+		PrintFormat("TrainWreck: Precompiled %1 loot pools for %2 containers", poolCount, containers.Count());
+	}
+	
+	
+	//! Re-read the loot table from LootFileName and apply only what changed. Pools and scav weights
+	//! of untouched arsenal types are kept. Removed items stay in the item index so saved items still load
+	bool ReloadLootTable()
+	{
+		if(!HasLoaded)
+			return false;
+		
+		int startTime = System.GetTickCount();
+		LootManagerSettings fileSettings = new LootManagerSettings();
+		SCR_JsonLoadContext context = TW_Util.LoadJsonFile(LootFileName, true);
+		
+		if(!context || !context.ReadValue("", fileSettings) || !fileSettings.LootTable)
+		{
+			PrintFormat("TrainWreck: Reload failed, unable to read %1. Keeping the current loot table", LootFileName, LogLevel.ERROR);
+			return false;
+		}
+		
+		ref map<string, SCR_EArsenalItemType> typeMap = new map<string, SCR_EArsenalItemType>();
+		foreach(SCR_EArsenalItemType arsenalType : s_ArsenalItemTypes)
+			typeMap.Set(TW_Util.ArsenalTypeAsString(arsenalType), arsenalType);
+		
+		// Where every current entry lives, to diff against
+		ref map<ResourceName, SCR_EArsenalItemType> oldTypes = new map<ResourceName, SCR_EArsenalItemType>();
+		foreach(SCR_EArsenalItemType oldType, ref array<ref TW_LootConfigItem> oldItems : s_LootTable)
+		{
+			foreach(TW_LootConfigItem oldItem : oldItems)
+				oldTypes.Set(oldItem.resourceName, oldType);
+		}
+		
+		ref map<SCR_EArsenalItemType, ref array<ref TW_LootConfigItem>> table = new map<SCR_EArsenalItemType, ref array<ref TW_LootConfigItem>>();
+		SCR_EArsenalItemType changedTypes = 0;
+		int added = 0;
+		int reweighted = 0;
+		
+		foreach(string typeName, ref array<ref TW_LootConfigItem> fileItems : fileSettings.LootTable)
+		{
+			SCR_EArsenalItemType itemType;
+			if(!typeMap.Find(typeName, itemType))
+			{
+				PrintFormat("TrainWreck: JsonFile '%1' -> Invalid SCR_EArsenalItemType '%2'. Skipping Section...", LootFileName, typeName, LogLevel.ERROR);
+				continue;
+			}
+			
+			foreach(TW_LootConfigItem fileItem : fileItems)
+			{
+				// Same filter as the initial load
+				if(!fileItem.isEnabled && fileItem.chanceToSpawn > 0)
+					continue;
+				
+				// Listed twice, or under another type earlier in the file
+				if(oldTypes.Contains(fileItem.resourceName) && oldTypes.Get(fileItem.resourceName) == -1)
+					continue;
+				
+				if(!GetPrefabResource(fileItem.resourceName))
+				{
+					PrintFormat("TrainWreck: LootType('%1') -> Prefab Invalid: '%2'", typeName, fileItem.resourceName, LogLevel.WARNING);
+					continue;
+				}
+				
+				TW_LootConfigItem entry;
+				TW_LootItemInfo info = s_ItemInfo.Get(fileItem.resourceName);
+				SCR_EArsenalItemType previousType;
+				bool wasListed = oldTypes.Find(fileItem.resourceName, previousType);
+				
+				if(info)
+				{
+					// Update the indexed config in place so existing references see the new weights
+					entry = info.GetConfig();
+					
+					if(!wasListed)
+					{
+						added++;
+						changedTypes = changedTypes | itemType;
+					}
+					else if(previousType != itemType)
+					{
+						reweighted++;
+						changedTypes = changedTypes | itemType | previousType;
+					}
+					else if(entry.chanceToSpawn != fileItem.chanceToSpawn || entry.randomSpawnCount != fileItem.randomSpawnCount || entry.isEnabled != fileItem.isEnabled)
+					{
+						reweighted++;
+						changedTypes = changedTypes | itemType;
+					}
+					
+					entry.chanceToSpawn = fileItem.chanceToSpawn;
+					entry.randomSpawnCount = fileItem.randomSpawnCount;
+					entry.isEnabled = fileItem.isEnabled;
+					entry.tags = fileItem.tags;
+				}
+				else
+				{
+					entry = fileItem;
+					RegisterItem(entry);
+					added++;
+					changedTypes = changedTypes | itemType;
+				}
+				
+				// Mark as consumed, anything left with a real type afterwards was removed
+				oldTypes.Set(fileItem.resourceName, -1);
+				
+				if(!table.Contains(itemType))
+					table.Insert(itemType, {});
+				
+				table.Get(itemType).Insert(entry);
+			}
+		}
+		
+		int removed = 0;
+		foreach(ResourceName removedName, SCR_EArsenalItemType removedType : oldTypes)
+		{
+			if(removedType == -1)
+				continue;
+			
+			removed++;
+			changedTypes = changedTypes | removedType;
+		}
+		
+		if(changedTypes == 0)
+		{
+			PrintFormat("TrainWreck: Reloaded %1, nothing changed", LootFileName);
+			return true;
+		}
+		
+		s_LootTable = table;
+		IndexLootPrefabs();
+		InvalidateLootPools(changedTypes);
+		TW_RandomInventoryComponent.OnLootTableChanged(changedTypes);
+		
+		PrintFormat("TrainWreck: Reloaded %1 in %2ms. Added %3, removed %4, reweighted %5", LootFileName, System.GetTickCount() - startTime, added, removed, reweighted);
+		return true;
+	}
+	
+	//! Append the current metrics as one CSV row, writing the header when the file is new
+	private void DumpMetrics()
+	{
+		bool isNewFile = !FileIO.FileExists(LootMetricsFileName);
+		FileHandle file = FileIO.OpenFile(LootMetricsFileName, FileMode.APPEND);
+		
+		if(!file)
+		{
+			PrintFormat("TrainWreck: Failed to write %1", LootMetricsFileName, LogLevel.WARNING);
+			return;
+		}
+		
+		if(isNewFile)
+			file.WriteLine(s_Metrics.FormatCsvHeader());
+		
+		float elapsed = TW_LootableInventoryComponent.GetGameMode().GetElapsedTime();
+		file.WriteLine(s_Metrics.FormatCsvRow(elapsed, s_SpawnQueue.Count(), s_LootedContainerCount, s_RecyclePool.Count()));
+		file.Close();
+	}
+	
+	//! Run the commands an admin dropped into LootCommandFileName, then delete it
+	private void PollCommandFile()
+	{
+		if(!FileIO.FileExists(LootCommandFileName))
+			return;
+		
+		ref array<string> commands = {};
+		FileHandle file = FileIO.OpenFile(LootCommandFileName, FileMode.READ);
+		
+		if(file)
+		{
+			string line;
+			while(file.ReadLine(line) >= 0)
+			{
+				line.TrimInPlace();
+				
+				if(!line.IsEmpty())
+					commands.Insert(line);
+			}
+			
+			file.Close();
+		}
+		
+		FileIO.DeleteFile(LootCommandFileName);
+		
+		foreach(string command : commands)
+			ExecuteCommand(command);
+	}
+	
+	//! Handle a single admin command
+	void ExecuteCommand(string command)
+	{
+		command.ToLower();
+		PrintFormat("TrainWreck: Loot command '%1'", command);
+		
+		ref array<string> args = {};
+		command.Split(" ", args, true);
+		
+		if(args.IsEmpty())
+			return;
+		
+		string name = args.Get(0);
+		
+		if(name == "reload")
+		{
+			ReloadLootTable();
+			return;
+		}
+		
+		if(name == "trace")
+		{
+			TW_LootTrace.Dump();
+			return;
+		}
+		
+		if(name == "metrics")
+		{
+			s_Metrics.PrintSummary(s_SpawnQueue.Count(), s_LootedContainerCount, s_RecyclePool.Count());
+			return;
+		}
+		
+		// benchmark [item count] [iterations]
+		if(name == "benchmark")
+		{
+			// The run blocks the frame and swaps out the live loot table
+			int playerCount = GetGame().GetPlayerManager().GetPlayerCount();
+			if(playerCount > 0)
+			{
+				PrintFormat("TrainWreck: Refusing to run loot benchmark with %1 players connected", playerCount, LogLevel.WARNING);
+				return;
+			}
+			
+			int itemCount = TW_LootBenchmark.DEFAULT_ITEM_COUNT;
+			int iterations = TW_LootBenchmark.SERVER_DEFAULT_ITERATIONS;
+			
+			if(args.Count() > 1)
+				itemCount = args.Get(1).ToInt();
+			if(args.Count() > 2)
+				iterations = args.Get(2).ToInt();
+			
+			TW_LootBenchmark benchmark = new TW_LootBenchmark(itemCount, iterations);
+			benchmark.Run();
+			return;
+		}
+		
+		PrintFormat("TrainWreck: Unknown loot command '%1'", command, LogLevel.WARNING);
+	}
+	
+	//! Initialize the entire loot system
+	void Initialize()
+	{
+		m_GameMode = SCR_BaseGameMode.Cast(GetGame().GetGameMode());
+		
+		if(!TW_MonitorPositions.GetInstance())
+		{
+			Print("TrainWreck: Position monitor is null. Unable to initialize Loot Manager", LogLevel.ERROR);
+			return;
+		}
+		
+		m_GameMode.GetOnInitializePlugins().Insert(AddListeners);
+		
+		m_GameMode.GetOnGameStarted().Insert(DelayInitialize);
 	}
 	
 	const string LootSpawnRadius = "TRAINWRECK_LOOT_RADIUS";
 	const string LootAntiSpawnRadius = "TRAINWRECK_LOOT_ANTIRADIUS";
 	
-	private void AddListeners()
+	private void AddListeners()
+	{
+		ref TW_MonitorPositions monitor = TW_MonitorPositions.GetInstance();
+		
+		InitializeLootTable();
+		TW_LootTrace.Configure(m_Settings.TraceCapacity, m_Settings.DumpTraceOnError);
+		
+		if(m_Settings.LootStateSaveIntervalSeconds > 0)
+			LoadLootState();
+		
+		if(m_Settings.RespawnSettings.IsLootRespawnable)
+		{
+			ref TW_OnPlayerPositionsChangedInvoker onRadiusCallback = monitor.AddGridSubscription(LootSpawnRadius, m_Settings.RespawnSettings.GridSize, m_Settings.RespawnSettings.RespawnLootRadius);
+			ref TW_OnPlayerPositionsChangedInvoker onAntiRadiusCallback = monitor.AddGridSubscription(LootAntiSpawnRadius, m_Settings.RespawnSettings.GridSize, m_Settings.RespawnSettings.DeadZoneRadius);
+			
+			onRadiusCallback.Insert(OnPlayerPositionsChanged);
+			onAntiRadiusCallback.Insert(OnPlayerPositionsChanged_AntiRadius);
+		}
+	}
+	
+	private void OnPlayerPositionsChanged(GridUpdateEvent gridInfo)
+	{
+		if(!m_Settings.PrewarmLootNearPlayers)
+		{
+			ToCellIds(gridInfo.GetPlayerChunks(), m_PlayerLocations);
+			return;
+		}
+		
+		ref set<int> previousLocations = new set<int>();
+		foreach(int previousCell : m_PlayerLocations)
+			previousLocations.Insert(previousCell);
+		
+		ToCellIds(gridInfo.GetPlayerChunks(), m_PlayerLocations);
+		
+		foreach(int cellId : m_PlayerLocations)
+		{
+			if(!previousLocations.Contains(cellId))
+				QueuePrewarm(cellId);
+		}
+		
+		if(!m_Settings.PrewarmStageEntities)
+			return;
+		
+		foreach(int previousCellId : previousLocations)
+		{
+			if(!m_PlayerLocations.Contains(previousCellId))
+				QueueUnstage(previousCellId);
+		}
+	}
+	
+	//! Schedule the staged, unsearched containers of a cell every player has left to be cleared
+	private void QueueUnstage(int cellId)
+	{
+		array<TW_LootableInventoryComponent> cellContainers = s_CellContainers.Get(cellId);
+		
+		if(!cellContainers)
+			return;
+		
+		float deadline = TW_LootableInventoryComponent.GetGameMode().GetElapsedTime() + STAGED_LOOT_LINGER_SECONDS;
+		
+		foreach(TW_LootableInventoryComponent container : cellContainers)
+		{
+			if(!container || !container.IsStaged() || container.IsQueuedForVirtualize())
+				continue;
+			
+			container.SetQueuedForVirtualize(true);
+			s_VirtualizeQueue.Push(container, deadline);
+		}
+	}
+	
+	//! Queue the unsearched containers of a cell a player just came within RespawnLootRadius of
+	private void QueuePrewarm(int cellId)
 	{
-		ref TW_MonitorPositions monitor = TW_MonitorPositions.GetInstance();
+		if(!m_Settings.IsLootEnabled)
+			return;
 		
-		InitializeLootTable();
+		array<TW_LootableInventoryComponent> cellContainers = s_CellContainers.Get(cellId);
 		
-		if(m_Settings.RespawnSettings.IsLootRespawnable)
+		if(!cellContainers)
+			return;
+		
+		foreach(TW_LootableInventoryComponent container : cellContainers)
 		{
-			ref TW_OnPlayerPositionsChangedInvoker onRadiusCallback = monitor.AddGridSubscription(LootSpawnRadius, m_Settings.RespawnSettings.GridSize, m_Settings.RespawnSettings.RespawnLootRadius);
-			ref TW_OnPlayerPositionsChangedInvoker onAntiRadiusCallback = monitor.AddGridSubscription(LootAntiSpawnRadius, m_Settings.RespawnSettings.GridSize, m_Settings.RespawnSettings.DeadZoneRadius);
-			
-			onRadiusCallback.Insert(OnPlayerPositionsChanged);
-			onAntiRadiusCallback.Insert(OnPlayerPositionsChanged_AntiRadius);
+			if(container && !container.HasBeenInteractedWith() && !container.IsPrewarmed())
+				s_PrewarmQueue.Insert(container);
 		}
+		
+		if(s_IsPrewarmRunning || s_PrewarmQueue.IsEmpty())
+			return;
+		
+		s_IsPrewarmRunning = true;
+		GetGame().GetCallqueue().CallLater(ProcessPrewarmQueue, 0, true);
 	}
 	
-	private void OnPlayerPositionsChanged(GridUpdateEvent gridInfo)
+	//! Pre-roll queued containers with whatever the frame budget has left. Loot that players are waiting on goes first
+	private void ProcessPrewarmQueue()
 	{
-		m_PlayerLocations.Clear();
-		m_PlayerLocations.Copy(gridInfo.GetPlayerChunks());
+		// Loot may have been disabled since the containers were queued
+		if(!m_Settings.IsLootEnabled)
+			s_PrewarmQueue.Clear();
+		
+		if(s_PrewarmQueue.IsEmpty())
+		{
+			s_IsPrewarmRunning = false;
+			GetGame().GetCallqueue().Remove(ProcessPrewarmQueue);
+			return;
+		}
+		
+		if(!s_SpawnQueue.IsEmpty())
+			return;
+		
+		int rolls = GetRespawnLootItemThreshold();
+		bool stageEntities = m_Settings.PrewarmStageEntities;
+		
+		s_FrameBudget.Begin();
+		
+		while(!s_PrewarmQueue.IsEmpty() && s_FrameBudget.HasBudget())
+		{
+			int last = s_PrewarmQueue.Count() - 1;
+			TW_LootableInventoryComponent container = s_PrewarmQueue.Get(last);
+			s_PrewarmQueue.Remove(last);
+			
+			// Deleted, searched or prewarmed through another cell since it was queued
+			if(!container || container.HasBeenInteractedWith() || container.IsPrewarmed())
+				continue;
+			
+			// Every player left before it came up, nothing would clear staged entities again
+			if(!m_PlayerLocations.Contains(GetContainerCellId(container)))
+				continue;
+			
+			TW_LootPool pool = GetLootPoolForContainer(container.GetTypeFlags(), container.GetModeFlags());
+			container.Prewarm(pool, rolls, stageEntities);
+			
+			// Staged entities are spawned through the spawn queue and budgeted there
+			s_FrameBudget.Consume();
+		}
+		
+		s_FrameBudget.End();
 	}
 	
 	private void OnPlayerPositionsChanged_AntiRadius(GridUpdateEvent gridInfo)
 	{
-		m_AntiSpawnPlayerLocations.Clear();
-		m_AntiSpawnPlayerLocations.Copy(gridInfo.GetPlayerChunks());
+		ToCellIds(gridInfo.GetPlayerChunks(), m_AntiSpawnPlayerLocations);
 	}
 	
 	//! This should keep
@@ -418,6 +1523,14 @@ sealed class TW_LootManager
 		if(IsDebug())
 			Print("TrainWreck: Initializing Loot System");
 		
+		s_RecyclePool.Configure(m_Settings.MaxRecycledItems, m_Settings.MaxRecycledItemsPerPrefab);
+		
+		LootRespawnSettings respawnSettings = m_Settings.RespawnSettings;
+		s_FrameBudget.Configure(respawnSettings.FrameBudgetMs, respawnSettings.TargetFrameTimeMs, respawnSettings.MinBatchSize, respawnSettings.MaxBatchSize);
+		
+		if(m_Settings.PreloadTopWeightedItems > 0)
+			PreloadTopWeightedItems(m_Settings.PreloadTopWeightedItems);
+		
 		if(m_Settings.RespawnSettings.IsLootRespawnable)
 		{
 			if(IsDebug())
@@ -425,186 +1538,451 @@ sealed class TW_LootManager
 			
 			GetGame().GetCallqueue().CallLater(RespawnLootProcessor, 1000 * GetRespawnCheckInterval(), true);
 		}	
+		else if(m_Settings.UseVirtualLoot)
+			Print("TrainWreck: UseVirtualLoot has no effect while IsLootRespawnable is off", LogLevel.WARNING);
+		
+		// Keep file I/O off the game start frame
+		if(s_HasPendingLootTableWrite)
+			GetGame().GetCallqueue().CallLater(FlushLootTableFiles, LOOT_TABLE_WRITE_DELAY_MS, false);
+		
+		if(m_Settings.LootStateSaveIntervalSeconds > 0)
+			GetGame().GetCallqueue().CallLater(SaveLootState, 1000 * m_Settings.LootStateSaveIntervalSeconds, true);
+		
+		if(m_Settings.MetricsDumpIntervalSeconds > 0)
+			GetGame().GetCallqueue().CallLater(DumpMetrics, 1000 * m_Settings.MetricsDumpIntervalSeconds, true);
+		
+		if(m_Settings.CommandPollIntervalSeconds > 0)
+			GetGame().GetCallqueue().CallLater(PollCommandFile, 1000 * m_Settings.CommandPollIntervalSeconds, true);
+	}
+	
+	private static ref array<ResourceName> s_PreloadQueue = {};
+	private static const int PRELOAD_BATCH_SIZE = 16;
+	
+	//! Queue the N most likely items for loading so the first container search does not hit cold resources
+	static void PreloadTopWeightedItems(int topCount)
+	{
+		// Chances are integers, so bucket by chance instead of sorting the items
+		ref map<int, ref array<ResourceName>> byChance = new map<int, ref array<ResourceName>>();
+		ref array<int> chances = {};
+		
+		foreach(SCR_EArsenalItemType type, ref array<ref TW_LootConfigItem> items : s_LootTable)
+		{
+			foreach(TW_LootConfigItem item : items)
+			{
+				if(!item.isEnabled || item.chanceToSpawn <= 0)
+					continue;
+				
+				if(!byChance.Contains(item.chanceToSpawn))
+				{
+					byChance.Insert(item.chanceToSpawn, {});
+					chances.Insert(item.chanceToSpawn);
+				}
+				
+				byChance.Get(item.chanceToSpawn).Insert(item.resourceName);
+			}
+		}
+		
+		chances.Sort(true);
+		s_PreloadQueue.Clear();
+		
+		foreach(int chance : chances)
+		{
+			foreach(ResourceName resourceName : byChance.Get(chance))
+			{
+				if(s_PreloadQueue.Count() >= topCount)
+					break;
+				
+				s_PreloadQueue.Insert(resourceName);
+			}
+		}
+		
+		PrintFormat("TrainWreck: Preloading %1 loot prefabs", s_PreloadQueue.Count());
+		GetGame().GetCallqueue().CallLater(PreloadPrefabBatch, 0, false);
+	}
+	
+	//! Load a handful of queued prefabs per frame until the queue is empty
+	private static void PreloadPrefabBatch()
+	{
+		int batch = Math.Min(PRELOAD_BATCH_SIZE, s_PreloadQueue.Count());
+		
+		for(int i = 0; i < batch; i++)
+		{
+			ResourceName resourceName = s_PreloadQueue.Get(s_PreloadQueue.Count() - 1);
+			s_PreloadQueue.Remove(s_PreloadQueue.Count() - 1);
+			
+			if(!GetPrefabResource(resourceName))
+				PrintFormat("TrainWreck: Unable to preload loot prefab '%1'", resourceName, LogLevel.WARNING);
+		}
+		
+		if(!s_PreloadQueue.IsEmpty())
+			GetGame().GetCallqueue().CallLater(PreloadPrefabBatch, 0, false);
+		else if(TW_LootManager.GetInstance().IsDebug())
+			PrintFormat("TrainWreck: Loot prefab cache holds %1 prefabs", s_PrefabResources.Count());
 	}
 	
-	private static ref set<string> m_PlayerLocations = new set<string>();
-	private static ref set<string> m_AntiSpawnPlayerLocations = new set<string>();
+	// Cell IDs near players, see GetGridCellId
+	private static ref set<int> m_PlayerLocations = new set<int>();
+	private static ref set<int> m_AntiSpawnPlayerLocations = new set<int>();
 	private static ref array<int> m_PlayerIds = new array<int>();
-	private static ref set<TW_LootableInventoryComponent> m_InteractedWithContainers = new set<TW_LootableInventoryComponent>();
-	private static int m_RespawnLootProcessor_ContainerIndex = -1;
-	private static int m_RespawnLootProcessor_BatchSize = 10;
+	
+	// Looted containers ordered by the time their loot may respawn
+	private static ref TW_LootContainerQueue s_RespawnQueue = new TW_LootContainerQueue();
+	
+	// Searched containers ordered by when they may go virtual, and staged containers by when they are cleared
+	private static ref TW_LootContainerQueue s_VirtualizeQueue = new TW_LootContainerQueue();
+	
+	// Seconds staged loot stays after every player left its cell, so walking along a cell edge does not churn it
+	private static const int STAGED_LOOT_LINGER_SECONDS = 10;
+	private static bool s_RespawnLootProcessor_IsContinuing;
+	
+	// Containers currently searched and waiting for their loot to respawn. s_RespawnQueue also holds stale entries, so its size is not this
+	private static int s_LootedContainerCount;
 	
 	static void RegisterInteractedContainer(TW_LootableInventoryComponent container)
 	{
-		if(!m_InteractedWithContainers.Contains(container))
-			m_InteractedWithContainers.Insert(container);
+		s_LootedContainerCount++;
+		s_Metrics.OnContainerLooted();
+		s_RespawnQueue.Push(container, container.GetRespawnLootAfterTime());
 	}
 	
-	static void UnregisterInteractedContainer(TW_LootableInventoryComponent container)
+	//! A registered container was reset or deleted
+	static void ReleaseInteractedContainer()
 	{
-		if(m_InteractedWithContainers.Contains(container))
-		{
-			m_InteractedWithContainers.RemoveItem(container);
-			container.SetInteractedWith(false);
-		}		
+		s_LootedContainerCount = Math.Max(0, s_LootedContainerCount - 1);
 	}
 	
-	private static int GetNextIndex(int current, int length)
+	//! Schedule a searched container to become virtual once it has been idle long enough
+	static void QueueForVirtualize(notnull TW_LootableInventoryComponent container)
 	{
-		current += 1;
-		
-		if(current >= length || current < 0)
-			return 0;
+		if(!s_Instance || !s_Instance.m_Settings.UseVirtualLoot || container.IsQueuedForVirtualize())
+			return;
 		
-		return current;
+		container.SetQueuedForVirtualize(true);
+		s_VirtualizeQueue.Push(container, container.GetLastInteractionTime() + s_Instance.m_Settings.VirtualizeAfterIdleSeconds);
 	}
 	
-	private static int GetPreviousIndex(int current, int length)
+	static void UnregisterInteractedContainer(TW_LootableInventoryComponent container)
 	{
-		current -= 1;
-		
-		if(current < 0)
-			current = length - 1;
-		
-		return current;
+		// Resetting starts a new loot cycle, which invalidates the queued entry
+		if(container.HasBeenInteractedWith())
+			container.SetInteractedWith(false);
 	}
 	
+	//! Reset containers whose respawn deadline has passed. Only containers that are actually due are touched
 	static void RespawnLootProcessor()
 	{
-		int length = m_InteractedWithContainers.Count();
+		TW_LootManager manager = TW_LootManager.GetInstance();
 		
-		if(TW_LootManager.GetInstance().IsDebug())
+		float now = TW_LootableInventoryComponent.GetGameMode().GetElapsedTime();
+		int retryDelay = manager.GetRespawnCheckInterval();
+		int processed = 0;
+		int startTime = System.GetTickCount();
+		
+		s_FrameBudget.Begin();
+		
+		while(s_FrameBudget.HasBudget() && s_RespawnQueue.PeekDeadline() <= now)
+		{
+			TW_LootableInventoryComponent container = s_RespawnQueue.Pop();
+			
+			// Deleted or already reset since it was queued
+			if(!container)
+				continue;
+			
+			processed++;
+			s_FrameBudget.Consume();
+			
+			float retryDeadline;
+			TW_LootRespawnOutcome outcome = GetRespawnOutcome(container.HasBeenInteractedWith(), container.GetRespawnLootAfterTime(), GetContainerCellId(container), m_AntiSpawnPlayerLocations, now, retryDelay, retryDeadline);
+			
+			switch(outcome)
+			{
+				case TW_LootRespawnOutcome.Reschedule:
+					s_RespawnQueue.Push(container, retryDeadline);
+					break;
+				
+				case TW_LootRespawnOutcome.Blocked:
+					TW_LootTrace.Record(TW_LootTraceEvent.RespawnSkippedAntiRadius, container.GetOwner().GetOrigin());
+					s_RespawnQueue.Push(container, retryDeadline);
+					s_Metrics.OnRespawnSkippedAntiRadius();
+					break;
+				
+				case TW_LootRespawnOutcome.Respawn:
+					TW_LootTrace.Record(TW_LootTraceEvent.RespawnPerformed, container.GetOwner().GetOrigin());
+					container.SetInteractedWith(false);
+					s_Metrics.OnRespawnPerformed();
+					break;
+			}
+		}
+		
+		processed += ProcessVirtualizeQueue(now, manager.m_Settings.UseVirtualLoot, manager.m_Settings.VirtualizeAfterIdleSeconds, retryDelay);
+		
+		s_FrameBudget.End();
+		
+		if(processed > 0)
+			s_Metrics.RecordTime(TW_LootSubsystem.Respawn, System.GetTickCount() - startTime);
+		
+		// Only frames that did work, an idle check every interval is not worth a log line
+		if(processed > 0 && manager.IsDebug())
+		{
+			PrintFormat("TrainWreck: Respawn processed %1 containers. Frame budget used %2/%3ms, batch size %4", processed, s_FrameBudget.GetUsedMs(), s_FrameBudget.GetBudgetMs(), s_FrameBudget.GetBatchSize());
+		}
+		
+		// Out of budget with containers still due, carry on next frame rather than waiting a full interval
+		bool hasDueContainers = s_RespawnQueue.PeekDeadline() <= now || s_VirtualizeQueue.PeekDeadline() <= now;
+		if(hasDueContainers && !s_RespawnLootProcessor_IsContinuing)
 		{
-			PrintFormat("TrainWreck: # of looted containers: %1", length);
+			s_RespawnLootProcessor_IsContinuing = true;
+			GetGame().GetCallqueue().CallLater(ContinueRespawnLootProcessor, 0, false);
 		}
+	}
+	
+	//! Decide what happens to a container popped from the respawn queue. Reschedule and Blocked go back in at retryDeadline.
+	//! Takes the container's state as values so TW_LootBenchmark can drive it with synthetic containers
+	static TW_LootRespawnOutcome GetRespawnOutcome(bool isInteracted, float respawnAfter, int cellId, set<int> blockedCells, float now, int retryDelay, out float retryDeadline)
+	{
+		if(!isInteracted)
+			return TW_LootRespawnOutcome.Drop;
 		
-		// Nothing to process if we don't have containers to check
-		if(length == 0) 
-			return;	
+		// Another interaction pushed the deadline back after this entry was queued
+		if(respawnAfter <= 0 || respawnAfter > now)
+		{
+			retryDeadline = respawnAfter;
+			
+			if(retryDeadline <= now)
+				retryDeadline = now + retryDelay;
+			
+			return TW_LootRespawnOutcome.Reschedule;
+		}
 		
-		int processLength = m_RespawnLootProcessor_BatchSize;
+		// Try again once the next check comes around
+		if(blockedCells.Contains(cellId))
+		{
+			retryDeadline = now + retryDelay;
+			return TW_LootRespawnOutcome.Blocked;
+		}
 		
-		if(processLength > length)
-			processLength = length;
+		return TW_LootRespawnOutcome.Respawn;
+	}
+	
+	//! Virtualize idle containers and clear staged ones with no player within RespawnLootRadius. Runs inside the respawn processor's budget
+	private static int ProcessVirtualizeQueue(float now, bool useVirtualLoot, int idleSeconds, int retryDelay)
+	{
+		int processed = 0;
 		
-		// We want to make sure if we hit the upper boundary
-		// we rollover to the beginning
-		for(int i = 0; i < processLength; i++)
+		while(s_FrameBudget.HasBudget() && s_VirtualizeQueue.PeekDeadline() <= now)
 		{
-			m_RespawnLootProcessor_ContainerIndex = GetNextIndex(m_RespawnLootProcessor_ContainerIndex, length);
-			TW_LootableInventoryComponent container = m_InteractedWithContainers.Get(m_RespawnLootProcessor_ContainerIndex);
+			TW_LootableInventoryComponent container = s_VirtualizeQueue.Pop();
 			
 			if(!container)
+				continue;
+			
+			processed++;
+			s_FrameBudget.Consume();
+			container.SetQueuedForVirtualize(false);
+			
+			// Staged ahead of a search that never came. A player back in the cell queues it again on leaving
+			if(container.IsStaged())
 			{
-				if(TW_LootManager.GetInstance().IsDebug())
-				{
-					Print("TrainWreck: Loot Container is null: removing from list...", LogLevel.WARNING);
-				}
+				if(!m_PlayerLocations.Contains(GetContainerCellId(container)))
+					container.Unstage();
 				
-				m_InteractedWithContainers.Remove(m_RespawnLootProcessor_ContainerIndex);
-				length -= 1;
-				m_RespawnLootProcessor_ContainerIndex = GetPreviousIndex(m_RespawnLootProcessor_ContainerIndex, length);
 				continue;
 			}
 			
-			if(TW_LootManager.GetInstance().IsDebug())
-			{
-				Print("TrainWreck: Can spawn loot: %1", container.CanRespawnLoot());
-			}
+			if(!useVirtualLoot || !container.HasBeenInteractedWith() || container.IsVirtual())
+				continue;
 			
-			string coordinate = TW_Util.ToGridText(container.GetOwner().GetOrigin(), TW_LootManager.GetInstance().GetLootSettings().RespawnSettings.GridSize);
+			// Searched again since this entry was queued
+			float idleUntil = container.GetLastInteractionTime() + idleSeconds;
 			
-			if(TW_LootManager.GetInstance().IsDebug())
+			if(idleUntil > now)
 			{
-				PrintFormat("TrainWreck: Loot Container Coordinate: %1", coordinate);
+				container.SetQueuedForVirtualize(true);
+				s_VirtualizeQueue.Push(container, idleUntil);
+				continue;
 			}
 			
-			if(m_AntiSpawnPlayerLocations.Contains(coordinate))
+			if(m_PlayerLocations.Contains(GetContainerCellId(container)))
 			{
-				if(TW_LootManager.GetInstance().IsDebug())
-				{
-					PrintFormat("TrainWreck: %1 - is within a no-respawn area around a player", coordinate, LogLevel.WARNING);
-				}
-				
+				container.SetQueuedForVirtualize(true);
+				s_VirtualizeQueue.Push(container, now + retryDelay);
 				continue;
 			}
 			
-			if(!container.CanRespawnLoot())
-				continue;
-			
-			container.SetInteractedWith(false);
-			m_InteractedWithContainers.Remove(m_RespawnLootProcessor_ContainerIndex);
-			
-			length -= 1;
-			
-			m_RespawnLootProcessor_ContainerIndex = GetPreviousIndex(m_RespawnLootProcessor_ContainerIndex, length);
-		}		
+			// Containers holding items that cannot be described stay materialized until the next search
+			if(container.Virtualize())
+				TW_LootTrace.Record(TW_LootTraceEvent.ContainerVirtualized, container.GetOwner().GetOrigin());
+		}
+		
+		return processed;
+	}
+	
+	private static void ContinueRespawnLootProcessor()
+	{
+		s_RespawnLootProcessor_IsContinuing = false;
+		RespawnLootProcessor();
 	}
 		
 	//! Trickle spawn loot into a container
-	void TrickleSpawnLootInContainer(TW_LootableInventoryComponent container, int remainingAmount)
+	void TrickleSpawnLootInContainer(TW_LootableInventoryComponent container, int remainingAmount, IEntity opener = null)
 	{
-		if(!m_Settings.IsLootEnabled|| !container || remainingAmount < 0) 
+		if(!m_Settings.IsLootEnabled|| !container || remainingAmount <= 0) 
 			return;
 		
-		ref WeightedType<ref TW_LootConfigItem> pool = new WeightedType<ref TW_LootConfigItem>();
-		GetLootPoolForContainer(container.GetTypeFlags(), pool);
-		TW_LootConfigItem arsenalItem = pool.GetRandomItem();
+		QueueLoot(container, remainingAmount, true, opener);
+	}
+	
+	//! Spawn loot in designated container
+	void SpawnLootInContainer(TW_LootableInventoryComponent container, IEntity opener = null)
+	{
+		if(!m_Settings.IsLootEnabled) 
+			return;
 		
-		if(!arsenalItem)
-		{
-			GetGame().GetCallqueue().CallLater(TrickleSpawnLootInContainer, 250, false, container, remainingAmount - 1);
+		if(!container) 
 			return;
-		}
 		
-		if(remainingAmount <= 0) 
+		// How many different things are we going to try spawning?
+		QueueLoot(container, Math.RandomIntInclusive(1, 4), false, opener);
+	}
+	
+	//! Drop pending loot for a container that was reset or deleted
+	static void CancelQueuedLoot(TW_LootableInventoryComponent container)
+	{
+		s_SpawnQueue.RemoveContainer(container);
+	}
+	
+	//! Spawn a container's manifest through the spawn queue, within the same per-frame limits as rolled loot.
+	//! Background work is served after everything a player is waiting on
+	static void QueueMaterialize(notnull TW_LootableInventoryComponent container, int itemCount, IEntity opener = null, bool isBackground = false)
+	{
+		if(!s_Instance || itemCount <= 0)
 			return;
+		
+		s_Instance.QueueLoot(container, itemCount, false, opener, true, isBackground);
+	}
+	
+	//! A container was searched while its background work is still queued, serve it like loot the searcher is waiting on
+	static void PromoteQueuedLoot(notnull TW_LootableInventoryComponent container, IEntity opener = null)
+	{
+		s_SpawnQueue.Promote(container, GetSpawnPriority(container, opener));
+	}
 	
-		int itemCount = Math.RandomIntInclusive(1, arsenalItem.randomSpawnCount);
-		container.InsertItem(arsenalItem);
+	private static float GetSpawnPriority(notnull TW_LootableInventoryComponent container, IEntity opener)
+	{
+		if(!opener)
+			return float.MAX;
 		
-		GetGame().GetCallqueue().CallLater(TrickleSpawnLootInContainer, 250, false, container, remainingAmount - 1);
+		return vector.DistanceSq(opener.GetOrigin(), container.GetOwner().GetOrigin());
 	}
 	
-	//! Spawn loot in designated container
-	void SpawnLootInContainer(TW_LootableInventoryComponent container)
+	private void QueueLoot(notnull TW_LootableInventoryComponent container, int rolls, bool isTrickle, IEntity opener, bool isMaterialize = false, bool isBackground = false)
 	{
-		if(!m_Settings.IsLootEnabled) 
+		s_SpawnQueue.Enqueue(container, rolls, isTrickle, GetSpawnPriority(container, opener), isMaterialize, isBackground);
+		
+		if(s_IsSpawnQueueRunning)
 			return;
 		
-		if(!container) 
+		s_IsSpawnQueueRunning = true;
+		GetGame().GetCallqueue().CallLater(ProcessSpawnQueue, 0, true);
+	}
+	
+	//! Spawn queued loot, nearest containers first, within the global per-frame limits
+	private void ProcessSpawnQueue()
+	{
+		if(s_SpawnQueue.IsEmpty())
+		{
+			s_IsSpawnQueueRunning = false;
+			GetGame().GetCallqueue().Remove(ProcessSpawnQueue);
 			return;
-			
-		int spawnCount = Math.RandomIntInclusive(1, 4);
+		}
 		
-		ref WeightedType<ref TW_LootConfigItem> pool = new WeightedType<ref TW_LootConfigItem>();
-		GetLootPoolForContainer(container.GetTypeFlags(), pool);
+		float now = GetGame().GetWorld().GetWorldTime();
+		int trickleDelay = GetTrickleSpawnDelay();
+		int maxSpawns = m_Settings.RespawnSettings.MaxSpawnsPerFrame;
+		int spawned = 0;
+		int index = 0;
+		int startTime = System.GetTickCount();
 		
-		// How many different things are we going to try spawning?								
-		for(int i = 0; i < spawnCount; i++)
-		{				
-			ref TW_LootConfigItem arsenalItem = pool.GetRandomItem();
-								
-			if(!arsenalItem)
+		s_FrameBudget.Begin();
+		
+		while(index < s_SpawnQueue.Count() && spawned < maxSpawns && s_FrameBudget.HasBudget())
+		{
+			TW_LootSpawnRequest request = s_SpawnQueue.Get(index);
+			
+			if(request.IsStale())
+			{
+				s_SpawnQueue.RemoveAt(index);
 				continue;
+			}
 			
-			// Add item a random amount of times to the container based on settings
-			int itemCount = Math.RandomIntInclusive(1, arsenalItem.randomSpawnCount);
-			bool tryAgain = false;
-			for(int x = 0; x < itemCount; x++)
+			if(request.m_NextSpawnTime > now)
 			{
-				bool success = container.InsertItem(arsenalItem);
-					
-				if(!success)
-				{
-					tryAgain = true;
-					break;
-				}
+				index++;
+				continue;
 			}
+			
+			request.m_RemainingRolls--;
+			
+			if(request.m_IsMaterialize)
+			{
+				// Nothing left in the manifest, or the container no longer holds one
+				if(!request.m_Container.MaterializeNext())
+					request.m_RemainingRolls = 0;
 				
-			if(tryAgain)
-				spawnCount--;
+				spawned++;
+				s_FrameBudget.Consume();
+				continue;
+			}
+			
+			int itemsSpawned;
+			bool success = SpawnLootRoll(request.m_Container, request.m_IsTrickle, itemsSpawned);
+			spawned += itemsSpawned;
+			s_FrameBudget.Consume(itemsSpawned);
+			
+			// A roll that did not fit costs an extra roll
+			if(!success && !request.m_IsTrickle)
+				request.m_RemainingRolls--;
+			
+			// Trickled containers wait before their next item, bulk requests keep going
+			if(request.m_IsTrickle)
+			{
+				request.m_NextSpawnTime = now + trickleDelay;
+				index++;
+			}
 		}
+		
+		s_FrameBudget.End();
+		
+		if(spawned > 0)
+			s_Metrics.RecordTime(TW_LootSubsystem.SpawnQueue, System.GetTickCount() - startTime);
+	}
+	
+	//! Draw one item for the container. Trickle rolls insert it once, bulk rolls insert it a random number of times
+	private bool SpawnLootRoll(TW_LootableInventoryComponent container, bool isTrickle, out int itemsSpawned)
+	{
+		itemsSpawned = 0;
+		TW_LootPool pool = GetLootPoolForContainer(container.GetTypeFlags(), container.GetModeFlags());
+		TW_LootConfigItem arsenalItem = pool.GetRandomItem();
+		
+		if(!arsenalItem)
+			return true;
+		
+		int itemCount = 1;
+		
+		// Add item a random amount of times to the container based on settings
+		if(!isTrickle)
+			itemCount = Math.RandomIntInclusive(1, arsenalItem.randomSpawnCount);
+		
+		for(int x = 0; x < itemCount; x++)
+		{
+			bool success = container.InsertItem(arsenalItem);
+			itemsSpawned++;
+			
+			if(!success)
+				return false;
+		}
+		
+		return true;
 	}
 	
 	static TW_LootConfigItem GetRandomByFlag(int type)
@@ -634,7 +2012,31 @@ sealed class TW_LootManager
 		return null;
 	}
 	
-	static void GetLootPoolForContainer(SCR_EArsenalItemType flags, notnull out WeightedType<ref TW_LootConfigItem> pool)
+	//! Cached loot pool for a container's type/mode masks. Built on first request, then shared until the loot table changes
+	static TW_LootPool GetLootPoolForContainer(SCR_EArsenalItemType flags, SCR_EArsenalItemMode modes = 0)
+	{
+		ref map<SCR_EArsenalItemMode, ref TW_LootPool> modePools = s_LootPoolCache.Get(flags);
+		
+		if(!modePools)
+		{
+			modePools = new map<SCR_EArsenalItemMode, ref TW_LootPool>();
+			s_LootPoolCache.Insert(flags, modePools);
+		}
+		
+		TW_LootPool pool = modePools.Get(modes);
+		
+		if(pool)
+			return pool;
+		
+		pool = new TW_LootPool();
+		BuildLootPool(flags, modes, pool);
+		pool.Compile();
+		modePools.Insert(modes, pool);
+		return pool;
+	}
+	
+	//! Filter the loot table into a weighted pool. A mode mask of 0 accepts every mode
+	private static void BuildLootPool(SCR_EArsenalItemType flags, SCR_EArsenalItemMode modes, notnull TW_LootPool pool)
 	{		
 		foreach(SCR_EArsenalItemType itemType : s_ArsenalItemTypes)
 		{
@@ -642,8 +2044,17 @@ sealed class TW_LootManager
 			{
 				ref array<ref TW_LootConfigItem> entries = s_LootTable.Get(itemType);				
 				foreach(TW_LootConfigItem item : entries)
-					if(item.isEnabled && item.chanceToSpawn > 0)
-						pool.Add(item, item.chanceToSpawn);
+				{
+					if(!item.isEnabled || item.chanceToSpawn <= 0)
+						continue;
+					
+					// Items that never came from a catalog have no known mode, so they are always allowed
+					SCR_EArsenalItemMode itemMode;
+					if(modes != 0 && s_ItemModes.Find(item.resourceName, itemMode) && (itemMode & modes) == 0)
+						continue;
+					
+					pool.Add(item, item.chanceToSpawn);
+				}
 			}
 		}
 	}
@@ -655,10 +2066,9 @@ sealed class TW_LootManager
 		{
 			foreach(TW_LootConfigItem item : items)
 			{				
-				if(!SCR_BaseContainerTools.FindComponentSource(Resource.Load(item.resourceName), "WeaponComponent"))
-				{
+				if(!GetItemInfo(item.resourceName).HasWeapon())
 					continue;
-				}
+				
 				weapons.Insert(item);
 				count++;
 			}
@@ -678,13 +2088,14 @@ sealed class TW_LootManager
 			{				
 				configs = s_LootTable.Get(flagType);
 				
+				if(!configs)
+					continue;
+				
 				foreach(TW_LootConfigItem config : configs)
 				{
-					if(ensureHasComponent != string.Empty)
-					{
-						if(!SCR_BaseContainerTools.FindComponentSource(Resource.Load(config.resourceName), ensureHasComponent))
-							continue;
-					}
+					if(ensureHasComponent != string.Empty && !GetItemInfo(config.resourceName).HasComponent(ensureHasComponent))
+						continue;
+					
 					count++;
 					items.Insert(config);
 				}
@@ -694,25 +2105,35 @@ sealed class TW_LootManager
 		return count;
 	}
 	
-	private bool OutputLootTableFile()
+	//! Copy the loot table into the settings that get written to LootFileName
+	private void PrepareLootTableOutput()
 	{
-		if(!m_Settings.LootTable)
-			m_Settings.LootTable = new map<string, ref array<ref TW_LootConfigItem>>();
-				
+		// Rebuilt from the indexed table, unknown sections are carried through as they were read
+		m_Settings.LootTable = new map<string, ref array<ref TW_LootConfigItem>>();
+		
 		foreach(SCR_EArsenalItemType type, ref array<ref TW_LootConfigItem> items : s_LootTable)
 		{	
-			PrintFormat("TrainWreckLooting: Type: %1, Amount %2 -- Saving", TW_Util.ArsenalTypeAsString(type), items.Count());
-						
-			m_Settings.LootTable.Set(TW_Util.ArsenalTypeAsString(type), items);
+			ref array<ref TW_LootConfigItem> output = {};
+			output.InsertAll(items);
+			m_Settings.LootTable.Set(TW_Util.ArsenalTypeAsString(type), output);
 		}
 		
-		return TW_Util.SaveJsonFile(LootFileName, m_Settings, true);
+		foreach(string typeName, ref array<ref TW_LootConfigItem> unknownItems : s_UnknownLootSections)
+			m_Settings.LootTable.Set(typeName, unknownItems);
 	}
 	
+	private bool OutputLootTableFile()
+	{
+		foreach(string typeName, ref array<ref TW_LootConfigItem> items : m_Settings.LootTable)
+			PrintFormat("TrainWreckLooting: Type: %1, Amount %2 -- Saving", typeName, items.Count());
+		
+		return TW_Util.SaveJsonFile(LootFileName, m_Settings, !m_Settings.WriteCompactLootTable);
+	}
+	
+	//! Existence check only, the file is parsed once by IngestLootTableFromFile
 	private static bool HasLootTable()
 	{
-		SCR_JsonLoadContext loadContext = new SCR_JsonLoadContext();
-		return loadContext.LoadFromFile(LootFileName);
+		return FileIO.FileExists(LootFileName);
 	}
 	
 	private static bool IngestLootTableFromFile(out LootManagerSettings settings)
@@ -723,6 +2144,7 @@ sealed class TW_LootManager
 		if(!loadSuccess)
 		{
 			Print("TrainWreck: Was unable to load loot map. Please verify it exists, and has valid syntax");
+			s_IsLootTableDirty = true;
 			return false;
 		}
 		
@@ -733,11 +2155,15 @@ sealed class TW_LootManager
 		foreach(SCR_EArsenalItemType type : itemTypes)
 			typeMap.Set(TW_Util.ArsenalTypeAsString(type), type);
 		
+		s_UnknownLootSections.Clear();
+		
 		foreach(string name, ref array<ref TW_LootConfigItem> items : settings.LootTable)
 		{
+			// Kept for the file only, a build that knows the type loads it
 			if(!typeMap.Contains(name))
 			{
-				PrintFormat("TrainWreck: JsonFile '%1' -> Invalid SCR_EArsenalItemType '%2'. Skipping Section...", LootFileName, name, LogLevel.ERROR);
+				PrintFormat("TrainWreck: JsonFile '%1' -> Unknown SCR_EArsenalItemType '%2'. Skipping Section...", LootFileName, name, LogLevel.WARNING);
+				s_UnknownLootSections.Set(name, items);
 				continue;
 			}
 			
@@ -748,20 +2174,23 @@ sealed class TW_LootManager
 			
 			foreach(TW_LootConfigItem item : items)
 			{
-				Resource resource = Resource.Load(item.resourceName);
-				if(!resource.IsValid())
+				// Validation fills the prefab cache, so spawning never reloads these
+				if(!GetPrefabResource(item.resourceName))
 				{
 					PrintFormat("TrainWreck: LootType('%1') -> Prefab Invalid: '%2'", name, item.resourceName, LogLevel.WARNING);
+					s_IsLootTableDirty = true;
 					continue;
 				}		
 				
 				if(HasLoaded)
 					PrintFormat("TrainWreck: Item: %1, Chance: %2", item.resourceName, item.chanceToSpawn);
 				
-				if(!s_GlobalItems.Contains(item.resourceName))
-					s_GlobalItems.Insert(item.resourceName);
-				else 
+				// Listed more than once, the file drops the duplicate
+				if(!RegisterItem(item))
+				{
+					s_IsLootTableDirty = true;
 					continue;
+				}
 				
 				s_LootTable.Get(itemType).Insert(item);
 			}
@@ -0,0 +1,71 @@
+//! Compact record of virtual loot: an interned item ID, how many, and the ammo each one holds (-1 when not applicable)
+class TW_LootManifestEntry
+{
+	int m_ItemId;
+	int m_Count;
+	int m_Ammo;
+};
+
+/*
+	Data-only contents of a virtual container.
+	
+	Items with the same ID and ammo share one record, so a stack of identical
+	magazines costs a single entry.
+*/
+class TW_LootManifest
+{
+	protected ref array<ref TW_LootManifestEntry> m_Entries = {};
+	
+	int Count() { return m_Entries.Count(); }
+	bool IsEmpty() { return m_Entries.IsEmpty(); }
+	TW_LootManifestEntry Get(int index) { return m_Entries.Get(index); }
+	void Clear() { m_Entries.Clear(); }
+	
+	void Add(int itemId, int ammo = -1)
+	{
+		foreach(TW_LootManifestEntry entry : m_Entries)
+		{
+			if(entry.m_ItemId == itemId && entry.m_Ammo == ammo)
+			{
+				entry.m_Count++;
+				return;
+			}
+		}
+		
+		ref TW_LootManifestEntry entry = new TW_LootManifestEntry();
+		entry.m_ItemId = itemId;
+		entry.m_Count = 1;
+		entry.m_Ammo = ammo;
+		m_Entries.Insert(entry);
+	}
+	
+	//! Take one item off the manifest, false when it is empty
+	bool PopItem(out int itemId, out int ammo)
+	{
+		int last = m_Entries.Count() - 1;
+		
+		if(last < 0)
+			return false;
+		
+		TW_LootManifestEntry entry = m_Entries.Get(last);
+		itemId = entry.m_ItemId;
+		ammo = entry.m_Ammo;
+		
+		entry.m_Count--;
+		if(entry.m_Count <= 0)
+			m_Entries.Remove(last);
+		
+		return true;
+	}
+	
+	//! Total number of items described
+	int GetItemCount()
+	{
+		int count = 0;
+		
+		foreach(TW_LootManifestEntry entry : m_Entries)
+			count += entry.m_Count;
+		
+		return count;
+	}
+};
@@ -0,0 +1,154 @@
+//! Parts of the loot system whose script time is tracked
+enum TW_LootSubsystem
+{
+	SpawnQueue,
+	Respawn,
+	Loadout
+};
+
+/*
+	Distribution of per-frame script time in milliseconds.
+	
+	Buckets hold slices that took at most 0, 1, 2, 4, 8 and 16ms, the last one
+	everything slower. GetTickCount has millisecond resolution, so finer buckets
+	would not mean anything.
+*/
+class TW_LootTimingHistogram
+{
+	protected static ref array<int> s_BucketLimits = {0, 1, 2, 4, 8, 16};
+	
+	protected ref array<int> m_Buckets = {0, 0, 0, 0, 0, 0, 0};
+	protected int m_Count;
+	protected int m_TotalMs;
+	protected int m_MaxMs;
+	
+	int GetCount() { return m_Count; }
+	int GetTotalMs() { return m_TotalMs; }
+	int GetMaxMs() { return m_MaxMs; }
+	
+	void Record(int elapsedMs)
+	{
+		m_Count++;
+		m_TotalMs += elapsedMs;
+		m_MaxMs = Math.Max(m_MaxMs, elapsedMs);
+		
+		int bucketCount = s_BucketLimits.Count();
+		for(int i = 0; i < bucketCount; i++)
+		{
+			if(elapsedMs <= s_BucketLimits.Get(i))
+			{
+				m_Buckets.Set(i, m_Buckets.Get(i) + 1);
+				return;
+			}
+		}
+		
+		m_Buckets.Set(bucketCount, m_Buckets.Get(bucketCount) + 1);
+	}
+	
+	//! Bucket counts separated by '/', fastest first
+	string FormatBuckets()
+	{
+		string text;
+		foreach(int index, int bucket : m_Buckets)
+		{
+			if(index > 0)
+				text += "/";
+			text += bucket.ToString();
+		}
+		
+		return text;
+	}
+};
+
+/*
+	Counters and timing histograms for the loot system.
+	
+	Counters are totals since the server started. Gauges such as queue depths are
+	read from the manager when a snapshot is printed or written. Recording is a
+	few integer adds, so it stays on whether or not debug logging is enabled.
+*/
+class TW_LootMetrics
+{
+	protected int m_ItemsSpawned;
+	protected int m_InsertFailures;
+	protected int m_ContainersLooted;
+	protected int m_RespawnsPerformed;
+	protected int m_RespawnsSkippedAntiRadius;
+	
+	protected ref array<ref TW_LootTimingHistogram> m_Timings = {};
+	protected ref array<TW_LootSubsystem> m_Subsystems = {};
+	
+	void TW_LootMetrics()
+	{
+		SCR_Enum.GetEnumValues(TW_LootSubsystem, m_Subsystems);
+		
+		foreach(TW_LootSubsystem subsystem : m_Subsystems)
+			m_Timings.Insert(new TW_LootTimingHistogram());
+	}
+	
+	int GetItemsSpawned() { return m_ItemsSpawned; }
+	int GetInsertFailures() { return m_InsertFailures; }
+	int GetContainersLooted() { return m_ContainersLooted; }
+	int GetRespawnsPerformed() { return m_RespawnsPerformed; }
+	int GetRespawnsSkippedAntiRadius() { return m_RespawnsSkippedAntiRadius; }
+	
+	void OnItemInserted(bool success)
+	{
+		if(success)
+			m_ItemsSpawned++;
+		else
+			m_InsertFailures++;
+	}
+	
+	void OnContainerLooted() { m_ContainersLooted++; }
+	void OnRespawnPerformed() { m_RespawnsPerformed++; }
+	void OnRespawnSkippedAntiRadius() { m_RespawnsSkippedAntiRadius++; }
+	
+	void RecordTime(TW_LootSubsystem subsystem, int elapsedMs)
+	{
+		m_Timings.Get(subsystem).Record(elapsedMs);
+	}
+	
+	TW_LootTimingHistogram GetTiming(TW_LootSubsystem subsystem)
+	{
+		return m_Timings.Get(subsystem);
+	}
+	
+	//! Column names matching FormatCsvRow
+	string FormatCsvHeader()
+	{
+		string header = "time_s,items_spawned,insert_failures,containers_looted,respawns,respawns_skipped_antiradius,spawn_queue_depth,looted_containers,recycled_items";
+		
+		foreach(TW_LootSubsystem subsystem : m_Subsystems)
+		{
+			string name = typename.EnumToString(TW_LootSubsystem, subsystem);
+			header += string.Format(",%1_slices,%1_total_ms,%1_max_ms,%1_histogram", name);
+		}
+		
+		return header;
+	}
+	
+	string FormatCsvRow(float timeSeconds, int spawnQueueDepth, int lootedContainers, int recycledItems)
+	{
+		string row = string.Format("%1,%2,%3,%4,%5,%6,%7,%8,%9", Math.Round(timeSeconds), m_ItemsSpawned, m_InsertFailures, m_ContainersLooted, m_RespawnsPerformed, m_RespawnsSkippedAntiRadius, spawnQueueDepth, lootedContainers, recycledItems);
+		
+		foreach(TW_LootTimingHistogram timing : m_Timings)
+			row += string.Format(",%1,%2,%3,%4", timing.GetCount(), timing.GetTotalMs(), timing.GetMaxMs(), timing.FormatBuckets());
+		
+		return row;
+	}
+	
+	//! Human readable summary for the metrics command
+	void PrintSummary(int spawnQueueDepth, int lootedContainers, int recycledItems)
+	{
+		PrintFormat("TrainWreck: Loot metrics - items spawned %1, insert failures %2, containers looted %3", m_ItemsSpawned, m_InsertFailures, m_ContainersLooted);
+		PrintFormat("TrainWreck: Loot metrics - respawns %1, skipped by anti-radius %2", m_RespawnsPerformed, m_RespawnsSkippedAntiRadius);
+		PrintFormat("TrainWreck: Loot metrics - spawn queue depth %1, looted containers %2, recycled items %3", spawnQueueDepth, lootedContainers, recycledItems);
+		
+		foreach(TW_LootSubsystem subsystem : m_Subsystems)
+		{
+			TW_LootTimingHistogram timing = m_Timings.Get(subsystem);
+			PrintFormat("TrainWreck: Loot metrics - %1: %2 slices, %3ms total, %4ms max, histogram (<=0/1/2/4/8/16/more ms) %5", typename.EnumToString(TW_LootSubsystem, subsystem), timing.GetCount(), timing.GetTotalMs(), timing.GetMaxMs(), timing.FormatBuckets());
+		}
+	}
+};
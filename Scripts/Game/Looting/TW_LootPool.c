@@ -0,0 +1,31 @@
+//! Weighted set of loot table entries backed by an alias table
+class TW_LootPool
+{
+	protected ref array<ref TW_LootConfigItem> m_Items = {};
+	protected ref TW_AliasSampler m_Sampler = new TW_AliasSampler();
+	
+	int Count() { return m_Items.Count(); }
+	bool IsEmpty() { return m_Items.IsEmpty(); }
+	
+	void Add(TW_LootConfigItem item, float weight)
+	{
+		m_Items.Insert(item);
+		m_Sampler.Add(weight);
+	}
+	
+	//! Build the sampler now rather than on the first draw
+	void Compile()
+	{
+		m_Sampler.Build();
+	}
+	
+	TW_LootConfigItem GetRandomItem()
+	{
+		int index = m_Sampler.GetRandomIndex();
+		
+		if(index < 0)
+			return null;
+		
+		return m_Items.Get(index);
+	}
+};
@@ -0,0 +1,121 @@
+/*
+	Parked loot entities waiting to be reused instead of deleted and spawned again.
+	
+	Parked entities are hidden, put to sleep and moved under the map. Entities are
+	owned by the world, so the pool only holds weak references; anything deleted by
+	other means while parked simply drops out.
+*/
+class TW_LootRecyclePool
+{
+	static const vector PARKING_POSITION = "0 -1000 0";
+	
+	protected ref map<ResourceName, ref array<IEntity>> m_Parked = new map<ResourceName, ref array<IEntity>>();
+	protected int m_Count;
+	protected int m_MaxItems;
+	protected int m_MaxItemsPerPrefab;
+	
+	void Configure(int maxItems, int maxItemsPerPrefab)
+	{
+		m_MaxItems = maxItems;
+		m_MaxItemsPerPrefab = maxItemsPerPrefab;
+	}
+	
+	bool IsEnabled() { return m_MaxItems > 0 && m_MaxItemsPerPrefab > 0; }
+	
+	//! Number of entries, including any deleted while parked since the pool last filled up
+	int Count() { return m_Count; }
+	
+	//! Park an entity for reuse. Returns false when the pool is full, the caller should delete it instead
+	bool Park(notnull IEntity entity, ResourceName prefab)
+	{
+		if(!IsEnabled())
+			return false;
+		
+		// Entities deleted while parked still hold a slot until they are pruned
+		if(m_Count >= m_MaxItems)
+			Prune();
+		
+		if(m_Count >= m_MaxItems)
+			return false;
+		
+		ref array<IEntity> parked = m_Parked.Get(prefab);
+		
+		if(!parked)
+		{
+			parked = {};
+			m_Parked.Insert(prefab, parked);
+		}
+		
+		if(parked.Count() >= m_MaxItemsPerPrefab)
+			m_Count -= PruneEntries(parked);
+		
+		if(parked.Count() >= m_MaxItemsPerPrefab)
+			return false;
+		
+		entity.ClearFlags(EntityFlags.VISIBLE | EntityFlags.TRACEABLE);
+		
+		Physics physics = entity.GetPhysics();
+		if(physics)
+			physics.SetActive(ActiveState.INACTIVE);
+		
+		entity.SetOrigin(PARKING_POSITION);
+		
+		parked.Insert(entity);
+		m_Count++;
+		return true;
+	}
+	
+	//! Reuse a parked entity of this prefab, null when none is available
+	IEntity Take(ResourceName prefab)
+	{
+		ref array<IEntity> parked = m_Parked.Get(prefab);
+		
+		if(!parked)
+			return null;
+		
+		while(!parked.IsEmpty())
+		{
+			int last = parked.Count() - 1;
+			IEntity entity = parked.Get(last);
+			parked.Remove(last);
+			m_Count--;
+			
+			if(!entity)
+				continue;
+			
+			entity.SetFlags(EntityFlags.VISIBLE | EntityFlags.TRACEABLE);
+			
+			Physics physics = entity.GetPhysics();
+			if(physics)
+				physics.SetActive(ActiveState.ACTIVE);
+			
+			return entity;
+		}
+		
+		return null;
+	}
+	
+	//! Drop entries whose entity was deleted while parked and recount the rest
+	protected void Prune()
+	{
+		foreach(ResourceName prefab, array<IEntity> parked : m_Parked)
+			m_Count -= PruneEntries(parked);
+	}
+	
+	//! Remove deleted entities from one prefab's list, returning how many were removed
+	protected static int PruneEntries(notnull array<IEntity> parked)
+	{
+		int removed = 0;
+		
+		for(int i = parked.Count() - 1; i >= 0; i--)
+		{
+			if(parked.Get(i))
+				continue;
+			
+			parked.Remove(i);
+			removed++;
+		}
+		
+		return removed;
+	}
+};
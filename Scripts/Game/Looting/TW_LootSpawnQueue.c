@@ -0,0 +1,120 @@
+//! Pending loot for one container, see TW_LootSpawnQueue
+class TW_LootSpawnRequest
+{
+	TW_LootableInventoryComponent m_Container;
+	
+	// Container loot cycle when queued. A reset container no longer matches
+	int m_Cycle;
+	
+	int m_RemainingRolls;
+	
+	// Trickle requests spawn a single item per roll and wait between rolls
+	bool m_IsTrickle;
+	
+	// Spawn the container's manifest one item per roll instead of drawing from its loot pool
+	bool m_IsMaterialize;
+	
+	// Squared distance to the player that opened the container, lower is served first
+	float m_Priority;
+	
+	// Work no player is waiting on, such as prewarm staging. Served after every other request
+	bool m_IsBackground;
+	
+	// World time in milliseconds when the next roll may spawn
+	float m_NextSpawnTime;
+	
+	bool IsStale()
+	{
+		return !m_Container || m_Container.GetLootCycle() != m_Cycle || m_RemainingRolls <= 0;
+	}
+};
+
+/*
+	Loot spawn work from every container, ordered by distance to the player who opened it.
+	
+	Requests are kept sorted by priority on insert. The queue is only as deep as the
+	number of containers currently being searched, so a linear insert is cheap.
+*/
+class TW_LootSpawnQueue
+{
+	protected ref array<ref TW_LootSpawnRequest> m_Requests = {};
+	
+	int Count() { return m_Requests.Count(); }
+	bool IsEmpty() { return m_Requests.IsEmpty(); }
+	TW_LootSpawnRequest Get(int index) { return m_Requests.Get(index); }
+	void RemoveAt(int index) { m_Requests.RemoveOrdered(index); }
+	void Clear() { m_Requests.Clear(); }
+	
+	void Enqueue(notnull TW_LootableInventoryComponent container, int rolls, bool isTrickle, float priority, bool isMaterialize = false, bool isBackground = false)
+	{
+		ref TW_LootSpawnRequest request = new TW_LootSpawnRequest();
+		request.m_Container = container;
+		request.m_Cycle = container.GetLootCycle();
+		request.m_RemainingRolls = rolls;
+		request.m_IsTrickle = isTrickle;
+		request.m_IsMaterialize = isMaterialize;
+		request.m_Priority = priority;
+		request.m_IsBackground = isBackground;
+		request.m_NextSpawnTime = GetGame().GetWorld().GetWorldTime();
+		
+		InsertSorted(request);
+	}
+	
+	//! Move a container's background requests in with the work players are waiting on
+	void Promote(TW_LootableInventoryComponent container, float priority)
+	{
+		ref array<ref TW_LootSpawnRequest> promoted = {};
+		
+		for(int i = m_Requests.Count() - 1; i >= 0; i--)
+		{
+			TW_LootSpawnRequest request = m_Requests.Get(i);
+			
+			if(request.m_Container != container || !request.m_IsBackground)
+				continue;
+			
+			promoted.Insert(request);
+			m_Requests.RemoveOrdered(i);
+		}
+		
+		foreach(TW_LootSpawnRequest request : promoted)
+		{
+			request.m_IsBackground = false;
+			request.m_Priority = priority;
+			InsertSorted(request);
+		}
+	}
+	
+	protected void InsertSorted(notnull TW_LootSpawnRequest request)
+	{
+		int count = m_Requests.Count();
+		for(int i = 0; i < count; i++)
+		{
+			if(IsServedBefore(request, m_Requests.Get(i)))
+			{
+				m_Requests.InsertAt(request, i);
+				return;
+			}
+		}
+		
+		m_Requests.Insert(request);
+	}
+	
+	//! Foreground before background, then by priority. Equal requests keep their queue order
+	protected static bool IsServedBefore(TW_LootSpawnRequest request, TW_LootSpawnRequest other)
+	{
+		if(request.m_IsBackground != other.m_IsBackground)
+			return !request.m_IsBackground;
+		
+		return request.m_Priority < other.m_Priority;
+	}
+	
+	//! Drop every request queued for this container
+	void RemoveContainer(TW_LootableInventoryComponent container)
+	{
+		for(int i = m_Requests.Count() - 1; i >= 0; i--)
+		{
+			if(m_Requests.Get(i).m_Container == container)
+				m_Requests.RemoveOrdered(i);
+		}
+	}
+};
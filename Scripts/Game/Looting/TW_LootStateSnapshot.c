@@ -0,0 +1,31 @@
+/*
+	Interaction state of searched containers, saved so a restart does not reset the map.
+	
+	Containers are static map objects, so they are keyed by their origin rounded to
+	a decimeter. Only searched containers are stored, with the seconds left until
+	their loot may respawn.
+*/
+class TW_LootStateSnapshot
+{
+	static const int FORMAT_VERSION = 1;
+	
+	int Version;
+	ref array<string> Positions = {};
+	ref array<int> RemainingSeconds = {};
+	
+	static string GetPositionKey(vector origin)
+	{
+		int x = Math.Round(origin[0] * 10);
+		int y = Math.Round(origin[1] * 10);
+		int z = Math.Round(origin[2] * 10);
+		return string.Format("%1 %2 %3", x, y, z);
+	}
+	
+	void Add(vector origin, int remainingSeconds)
+	{
+		Positions.Insert(GetPositionKey(origin));
+		RemainingSeconds.Insert(remainingSeconds);
+	}
+	
+	int Count() { return Positions.Count(); }
+};
@@ -0,0 +1,117 @@
+/*
+	Compact snapshot of the validated, merged loot table.
+	
+	Written after a cold start once every entry was validated and merged with the
+	faction catalogs. The whole item index is stored in ID order as parallel arrays,
+	including entries that were dropped from the table, so a warm start registers
+	the same IDs as a cold one. Entries carry the prefab capabilities resolved for
+	the item index, a warm start neither loads prefabs nor merges the catalogs. The
+	key ties the snapshot to the exact lootmap.json, faction catalog entries, loaded
+	addons, game build and world it was made from.
+*/
+class TW_LootTableCache
+{
+	static const int FORMAT_VERSION = 2;
+	
+	int Version;
+	string Key;
+	
+	//! Every setting except the loot table itself
+	ref LootManagerSettings Settings;
+	
+	ref array<string> ResourceNames = {};
+	ref array<int> Types = {};
+	ref array<int> Modes = {};
+	ref array<int> Chances = {};
+	ref array<int> SpawnCounts = {};
+	ref array<bool> Enabled = {};
+	ref array<string> Tags = {};
+	
+	//! False for index entries that are not part of the loot table
+	ref array<bool> Listed = {};
+	
+	// Resolved prefab capabilities, see TW_LootItemInfo
+	ref array<int> Capabilities = {};
+	ref array<int> Purposes = {};
+	ref array<int> SlotSizes = {};
+	ref array<string> DefaultMagazines = {};
+	
+	static const int CAPABILITY_WEAPON = 1;
+	static const int CAPABILITY_MAGAZINE = 2;
+	
+	//! Capabilities of an entry whose prefab was never resolved
+	static const int CAPABILITY_UNRESOLVED = -1;
+	
+	bool IsValid(string key)
+	{
+		return Version == FORMAT_VERSION && Key == key && Settings != null;
+	}
+	
+	int Count() { return ResourceNames.Count(); }
+	
+	//! Type is only meaningful when the entry is listed in the loot table
+	void AddItem(SCR_EArsenalItemType type, SCR_EArsenalItemMode mode, bool listed, notnull TW_LootConfigItem config, notnull TW_LootItemInfo info)
+	{
+		ResourceNames.Insert(config.resourceName);
+		Types.Insert(type);
+		Listed.Insert(listed);
+		Modes.Insert(mode);
+		Chances.Insert(config.chanceToSpawn);
+		SpawnCounts.Insert(config.randomSpawnCount);
+		Enabled.Insert(config.isEnabled);
+		
+		string tags;
+		if(config.tags)
+		{
+			foreach(string tag : config.tags)
+			{
+				if(!tags.IsEmpty())
+					tags += ",";
+				tags += tag;
+			}
+		}
+		Tags.Insert(tags);
+		
+		// Leave unresolved entries lazy instead of loading their prefab just to cache it
+		if(!info.IsResolved())
+		{
+			Capabilities.Insert(CAPABILITY_UNRESOLVED);
+			Purposes.Insert(EStoragePurpose.PURPOSE_ANY);
+			SlotSizes.Insert(0);
+			DefaultMagazines.Insert(string.Empty);
+			return;
+		}
+		
+		int capabilities = 0;
+		if(info.HasWeapon())
+			capabilities = capabilities | CAPABILITY_WEAPON;
+		if(info.HasMagazine())
+			capabilities = capabilities | CAPABILITY_MAGAZINE;
+		
+		Capabilities.Insert(capabilities);
+		Purposes.Insert(info.GetStoragePurpose());
+		SlotSizes.Insert(info.GetSlotSize());
+		DefaultMagazines.Insert(info.GetDefaultMagazine());
+	}
+	
+	//! Config entry for the item at index
+	TW_LootConfigItem CreateConfig(int index)
+	{
+		ref array<string> tags = {};
+		Tags.Get(index).Split(",", tags, true);
+		
+		TW_LootConfigItem config = new TW_LootConfigItem();
+		config.SetData(ResourceNames.Get(index), Chances.Get(index), SpawnCounts.Get(index), tags, Enabled.Get(index));
+		return config;
+	}
+	
+	//! Hand the cached capabilities of the item at index to its index record
+	void RestoreInfo(int index, notnull TW_LootItemInfo info)
+	{
+		int capabilities = Capabilities.Get(index);
+		if(capabilities == CAPABILITY_UNRESOLVED)
+			return;
+		
+		info.SetResolved((capabilities & CAPABILITY_WEAPON) != 0, (capabilities & CAPABILITY_MAGAZINE) != 0, Purposes.Get(index), SlotSizes.Get(index), DefaultMagazines.Get(index));
+	}
+};
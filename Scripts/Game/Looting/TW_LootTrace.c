@@ -0,0 +1,130 @@
+enum TW_LootTraceEvent
+{
+	ContainerSearched,
+	ItemSpawned,
+	InsertFailed,
+	RespawnPerformed,
+	RespawnSkippedAntiRadius,
+	ContainerVirtualized,
+	ContainerMaterialized,
+	LoadoutApplied
+};
+
+/*
+	Fixed-size ring buffer of loot events.
+	
+	Each record is a position, an event type, an item ID (or another ID that fits
+	the event, such as a loadout template) and the world time in milliseconds.
+	Records are written into preallocated parallel arrays, so recording is a few
+	stores and never formats strings or touches the log. The oldest records are
+	overwritten once the buffer is full. Dump writes the buffer oldest first to
+	the log and to LootTraceFileName.
+*/
+class TW_LootTrace
+{
+	static const string LootTraceFileName = "$profile:loottrace.csv";
+	
+	// At most one dump on error per this many milliseconds of world time
+	protected static const float ERROR_DUMP_COOLDOWN_MS = 60000;
+	
+	protected static bool s_IsEnabled;
+	protected static bool s_DumpOnError;
+	protected static float s_LastErrorDump = -1;
+	
+	protected static int s_Capacity;
+	protected static int s_Head;
+	protected static int s_Count;
+	
+	protected static ref array<vector> s_Positions = {};
+	protected static ref array<int> s_Events = {};
+	protected static ref array<int> s_ItemIds = {};
+	protected static ref array<float> s_Times = {};
+	
+	static bool IsEnabled() { return s_IsEnabled; }
+	static int Count() { return s_Count; }
+	
+	//! Allocate the buffer. A capacity of 0 turns tracing off
+	static void Configure(int capacity, bool dumpOnError)
+	{
+		s_Capacity = Math.Max(0, capacity);
+		s_IsEnabled = s_Capacity > 0;
+		s_DumpOnError = dumpOnError;
+		s_Head = 0;
+		s_Count = 0;
+		
+		s_Positions.Resize(s_Capacity);
+		s_Events.Resize(s_Capacity);
+		s_ItemIds.Resize(s_Capacity);
+		s_Times.Resize(s_Capacity);
+	}
+	
+	static void Record(TW_LootTraceEvent traceEvent, vector position, int itemId = -1)
+	{
+		if(!s_IsEnabled)
+			return;
+		
+		s_Positions.Set(s_Head, position);
+		s_Events.Set(s_Head, traceEvent);
+		s_ItemIds.Set(s_Head, itemId);
+		s_Times.Set(s_Head, GetGame().GetWorld().GetWorldTime());
+		
+		s_Head++;
+		if(s_Head >= s_Capacity)
+			s_Head = 0;
+		
+		if(s_Count < s_Capacity)
+			s_Count++;
+	}
+	
+	//! Dump the buffer after an error, unless one was dumped recently
+	static void DumpOnError(string reason)
+	{
+		if(!s_IsEnabled || !s_DumpOnError)
+			return;
+		
+		float now = GetGame().GetWorld().GetWorldTime();
+		
+		if(s_LastErrorDump >= 0 && now - s_LastErrorDump < ERROR_DUMP_COOLDOWN_MS)
+			return;
+		
+		s_LastErrorDump = now;
+		PrintFormat("TrainWreck: Dumping loot trace after error: %1", reason, LogLevel.WARNING);
+		Dump();
+	}
+	
+	//! Write every record, oldest first, to LootTraceFileName and a short summary to the log
+	static void Dump()
+	{
+		if(!s_IsEnabled)
+		{
+			Print("TrainWreck: Loot trace is disabled, set TraceCapacity to enable it");
+			return;
+		}
+		
+		FileHandle file = FileIO.OpenFile(LootTraceFileName, FileMode.WRITE);
+		
+		if(!file)
+		{
+			PrintFormat("TrainWreck: Failed to write %1", LootTraceFileName, LogLevel.WARNING);
+			return;
+		}
+		
+		file.WriteLine("time_ms,event,item_id,x,y,z");
+		
+		int start = s_Head - s_Count;
+		if(start < 0)
+			start += s_Capacity;
+		
+		for(int i = 0; i < s_Count; i++)
+		{
+			int index = (start + i) % s_Capacity;
+			vector position = s_Positions.Get(index);
+			string eventName = typename.EnumToString(TW_LootTraceEvent, s_Events.Get(index));
+			
+			file.WriteLine(string.Format("%1,%2,%3,%4,%5,%6", s_Times.Get(index), eventName, s_ItemIds.Get(index), position[0], position[1], position[2]));
+		}
+		
+		file.Close();
+		PrintFormat("TrainWreck: Wrote %1 loot trace records to %2", s_Count, LootTraceFileName);
+	}
+};
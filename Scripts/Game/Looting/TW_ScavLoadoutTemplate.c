@@ -0,0 +1,51 @@
+/*
+	A scav loadout rolled ahead of time.
+
+	Holds the resolved equipment prefabs with the storage purpose each one is
+	inserted with, and the weapons with how many magazines to give for each.
+	Applying a template to a character only spawns and inserts, no weighted
+	draws happen at spawn time.
+*/
+class TW_ScavLoadoutTemplate
+{
+	protected int m_Id;
+
+	protected ref array<ResourceName> m_Prefabs = {};
+	protected ref array<EStoragePurpose> m_Purposes = {};
+
+	protected ref array<ResourceName> m_Weapons = {};
+	protected ref array<int> m_MagazineCounts = {};
+
+	void TW_ScavLoadoutTemplate(int id)
+	{
+		m_Id = id;
+	}
+
+	int GetId() { return m_Id; }
+
+	void AddPrefab(ResourceName prefab, EStoragePurpose purpose = EStoragePurpose.PURPOSE_ANY)
+	{
+		if(prefab == ResourceName.Empty)
+			return;
+
+		m_Prefabs.Insert(prefab);
+		m_Purposes.Insert(purpose);
+	}
+
+	void AddWeapon(ResourceName weapon, int magazineCount)
+	{
+		if(weapon == ResourceName.Empty)
+			return;
+
+		m_Weapons.Insert(weapon);
+		m_MagazineCounts.Insert(magazineCount);
+	}
+
+	int GetPrefabCount() { return m_Prefabs.Count(); }
+	ResourceName GetPrefab(int index) { return m_Prefabs.Get(index); }
+	EStoragePurpose GetPurpose(int index) { return m_Purposes.Get(index); }
+
+	int GetWeaponCount() { return m_Weapons.Count(); }
+	ResourceName GetWeapon(int index) { return m_Weapons.Get(index); }
+	int GetMagazineCount(int index) { return m_MagazineCounts.Get(index); }
+};
@@ -0,0 +1,53 @@
+/*
+	Draws distinct indices from [0, count) without replacement.
+	
+	Sparse partial Fisher-Yates shuffle: only displaced positions are stored,
+	so drawing k indices costs O(k) regardless of how large the range is.
+*/
+class TW_UniqueIndexSampler
+{
+	protected int m_Count;
+	protected int m_Drawn;
+	protected ref map<int, int> m_Displaced = new map<int, int>();
+	
+	void TW_UniqueIndexSampler(int count = 0)
+	{
+		Reset(count);
+	}
+	
+	void Reset(int count)
+	{
+		m_Count = count;
+		m_Drawn = 0;
+		m_Displaced.Clear();
+	}
+	
+	int Remaining() { return m_Count - m_Drawn; }
+	
+	//! Next distinct random index, or -1 once every index has been drawn
+	int Next()
+	{
+		if(m_Drawn >= m_Count)
+			return -1;
+		
+		int position = Math.RandomInt(m_Drawn, m_Count);
+		int value = ValueAt(position);
+		
+		// Move the value at the front of the undrawn range into the picked slot
+		m_Displaced.Set(position, ValueAt(m_Drawn));
+		m_Displaced.Remove(m_Drawn);
+		m_Drawn++;
+		
+		return value;
+	}
+	
+	protected int ValueAt(int position)
+	{
+		int value;
+		
+		if(m_Displaced.Find(position, value))
+			return value;
+		
+		return position;
+	}
+};
@@ -35,15 +35,8 @@ modded class SCR_PlayerController
 		TW_LootManager lootManager = TW_LootManager.GetInstance();
 		
 		if(lootManager)
-		{
 			lootManager.PrintSettings();
-			
-			if(lootManager.IsDebug())
-			{
-				Print("TrainWreck: Setting container interacted with to true");
-			}
-		}
 		
-		container.SetInteractedWith(true);
+		container.SetInteractedWith(true, GetControlledEntity());
 	}
 };
\ No newline at end of file
@@ -0,0 +1,20 @@
+[WorkbenchPluginAttribute(name: "TrainWreck Loot Benchmark", category: "TrainWreck Plugins", wbModules: {"WorldEditor"})]
+class TrainWreckLootBenchmarkPlugin : WorldEditorPlugin
+{
+	[Attribute("1000", UIWidgets.EditBox, "Number of synthetic loot table items")]
+	protected int m_ItemCount;
+	
+	[Attribute("100000", UIWidgets.EditBox, "Calls timed per benchmarked path")]
+	protected int m_Iterations;
+	
+	override void Run()
+	{
+		ref TW_LootBenchmark benchmark = new TW_LootBenchmark(m_ItemCount, m_Iterations);
+		benchmark.Run();
+	}
+	
+	override void Configure()
+	{
+		Workbench.ScriptDialog("Configure Loot Benchmark", "", this);
+	}
+}